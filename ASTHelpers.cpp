@@ -11,6 +11,7 @@
 #include "CodeGenerator.h"
 #include "Insights.h"
 #include "InsightsHelpers.h"
+#include "InsightsScratchArena.h"
 #include "InsightsStaticStrings.h"
 #include "InsightsStrCat.h"
 //-----------------------------------------------------------------------------
@@ -24,7 +25,7 @@ DeclStmt* _mkDeclStmt(std::span<Decl*> decls)
 
     auto dgRef = DeclGroupRef::Create(const_cast<ASTContext&>(ctx), decls.data(), decls.size());
 
-    return new(ctx) DeclStmt(dgRef, {}, {});
+    return GetScratchArena().New<DeclStmt>(dgRef, SourceLocation{}, SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -152,7 +153,7 @@ CXXCatchStmt* Catch(ArrayRef<Stmt*> body)
 {
     CompoundStmt* compStmt = mkCompoundStmt(body);
 
-    return new(GetGlobalAST()) CXXCatchStmt({}, nullptr, compStmt);
+    return GetScratchArena().New<CXXCatchStmt>(SourceLocation{}, nullptr, compStmt);
 }
 //-----------------------------------------------------------------------------
 
@@ -164,14 +165,15 @@ CXXCatchStmt* Catch(Stmt* body)
 
 CXXThrowExpr* Throw(const Expr* expr)
 {
-    return new(GetGlobalAST()) CXXThrowExpr(const_cast<Expr*>(expr), VoidTy(), {}, false);
+    return GetScratchArena().New<CXXThrowExpr>(const_cast<Expr*>(expr), VoidTy(), SourceLocation{}, false);
 }
 //-----------------------------------------------------------------------------
 
 UnaryExprOrTypeTraitExpr* Sizeof(QualType toType)
 {
     const auto& ctx = GetGlobalAST();
-    return new(ctx) UnaryExprOrTypeTraitExpr(UETT_SizeOf, ctx.getTrivialTypeSourceInfo(toType), toType, {}, {});
+    return GetScratchArena().New<UnaryExprOrTypeTraitExpr>(
+        UETT_SizeOf, ctx.getTrivialTypeSourceInfo(toType), toType, SourceLocation{}, SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -195,7 +197,7 @@ CanQualType VoidTy()
 
 ParenExpr* Paren(Expr* expr)
 {
-    return new(GetGlobalAST()) ParenExpr({}, {}, expr);
+    return GetScratchArena().New<ParenExpr>(SourceLocation{}, SourceLocation{}, expr);
 }
 //-----------------------------------------------------------------------------
 
@@ -281,7 +283,7 @@ auto* mkLabelDecl(std::string_view name)
 
 LabelStmt* Label(std::string_view name)
 {
-    return new(GetGlobalAST()) LabelStmt({}, mkLabelDecl(name), nullptr);
+    return GetScratchArena().New<LabelStmt>(SourceLocation{}, mkLabelDecl(name), nullptr);
 }
 //-----------------------------------------------------------------------------
 
@@ -342,7 +344,7 @@ BinaryOperator* Plus(Expr* var, Expr* assignExpr)
 
 GotoStmt* Goto(std::string_view labelName)
 {
-    return new(GetGlobalAST()) GotoStmt(mkLabelDecl(labelName), {}, {});
+    return GetScratchArena().New<GotoStmt>(mkLabelDecl(labelName), SourceLocation{}, SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -477,7 +479,7 @@ SwitchStmt* Switch(Expr* stmt)
 
 BreakStmt* Break()
 {
-    return new(GetGlobalAST()) BreakStmt(SourceLocation{});
+    return GetScratchArena().New<BreakStmt>(SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -511,7 +513,9 @@ NullStmt* mkNullStmt()
 
 Stmt* Comment(std::string_view comment)
 {
-    return new(GetGlobalAST()) CppInsightsCommentStmt{comment};
+    auto& arena = GetScratchArena();
+
+    return arena.New<CppInsightsCommentStmt>(arena.Copy(comment));
 }
 //-----------------------------------------------------------------------------
 
@@ -549,7 +553,8 @@ FieldDecl* mkFieldDecl(DeclContext* dc, std::string_view name, QualType type)
 
 InitListExpr* InitList(ArrayRef<Expr*> initExprs, QualType t)
 {
-    auto* initList = new(GetGlobalAST()) InitListExpr(GetGlobalAST(), SourceLocation{}, initExprs, SourceLocation{});
+    auto* initList =
+        GetScratchArena().New<InitListExpr>(GetGlobalAST(), SourceLocation{}, initExprs, SourceLocation{});
     initList->setType(t);
 
     return initList;
@@ -558,8 +563,12 @@ InitListExpr* InitList(ArrayRef<Expr*> initExprs, QualType t)
 
 ArraySubscriptExpr* ArraySubscript(const Expr* lhs, uint64_t index, QualType type)
 {
-    return new(GetGlobalAST()) ArraySubscriptExpr(
-        const_cast<Expr*>(lhs), Int32(index), type, ExprValueKind::VK_LValue, ExprObjectKind::OK_Ordinary, {});
+    return GetScratchArena().New<ArraySubscriptExpr>(const_cast<Expr*>(lhs),
+                                                     Int32(index),
+                                                     type,
+                                                     ExprValueKind::VK_LValue,
+                                                     ExprObjectKind::OK_Ordinary,
+                                                     SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -651,7 +660,7 @@ CallExpr* CallConstructor(QualType        ctorType,
 CXXBoolLiteralExpr* Bool(bool b)
 {
     auto& ctx = GetGlobalAST();
-    return new(ctx) CXXBoolLiteralExpr(b, ctx.BoolTy, {});
+    return GetScratchArena().New<CXXBoolLiteralExpr>(b, ctx.BoolTy, SourceLocation{});
 }
 //-----------------------------------------------------------------------------
 
@@ -1089,7 +1089,7 @@ void CfrontCodeGenerator::InsertArg(const CXXMemberCallExpr* stmt)
 
             auto destType = not isPointer ? Ptr(obj->getType()) : obj->getType();
             auto atype    = isPointer ? obj->getType()->getPointeeType() : obj->getType();
-            auto idx      = mVirtualFunctions[{md, {atype->getAsCXXRecordDecl(), vRecordDecl}}];
+            auto idx      = mVirtualFunctions.lookup({md, {atype->getAsCXXRecordDecl(), vRecordDecl}});
 
             // a->__vptr[1];  #1
             auto* accessVptr   = AccessMember(Paren(obj), vtblField, true);
@@ -1174,7 +1174,7 @@ void CfrontCodeGenerator::InsertArg(const FunctionDecl* stmt)
 
 void CfrontCodeGenerator::InsertArg(const CXXConstructExpr* stmt)
 {
-    if(P0315Visitor dt{*this}; not dt.TraverseType(stmt->getType())) {
+    if(P0315Visitor dt{*this}; not dt.TraverseTypeIfLambda(stmt->getType())) {
         if(not mLambdaStack.empty()) {
             for(const auto& e : mLambdaStack) {
                 RETURN_IF(LambdaCallerType::VarDecl == e.callerType());
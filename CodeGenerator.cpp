@@ -6,6 +6,8 @@
  ****************************************************************************/
 
 #include <algorithm>
+#include <array>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -21,7 +23,10 @@
 #include "clang/AST/RecordLayout.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Path.h"
 //-----------------------------------------------------------------------------
 
@@ -306,6 +311,18 @@ static T ValueOr(bool b, T val, T el)
 }
 //-----------------------------------------------------------------------------
 
+///! The loops of the translation unit, for \c --edu-show-static-guards.
+/*constinit*/ static SmallVector<const Stmt*, 16> gLoops{};
+//-----------------------------------------------------------------------------
+
+static void PushLoop(const Stmt* loop)
+{
+    if(GetInsightsOptions().UseShowStaticGuards) {
+        gLoops.push_back(loop);
+    }
+}
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::InsertArg(const CXXDependentScopeMemberExpr* stmt)
 {
     if(not stmt->isImplicitAccess()) {
@@ -322,6 +339,8 @@ void CodeGenerator::InsertArg(const CXXDependentScopeMemberExpr* stmt)
 
 void CodeGenerator::InsertArg(const CXXForRangeStmt* rangeForStmt)
 {
+    PushLoop(rangeForStmt);
+
     auto&      langOpts{GetLangOpts(*rangeForStmt->getLoopVariable())};
     const bool onlyCpp11{not langOpts.CPlusPlus17};
 
@@ -349,6 +368,8 @@ void CodeGenerator::InsertArg(const CXXForRangeStmt* rangeForStmt)
 
     const auto& ctx = rangeForStmt->getLoopVariable()->getASTContext();
 
+    BackupAndRestore _{mRangeForLoopVar, rangeForStmt->getLoopVariable()};
+
     // In case of a range-based for-loop inside an unevaluated template the begin and end statements are not present. In
     // this case just add a nullptr.
     auto* declStmt = [&]() -> DeclStmt* {
@@ -432,17 +453,27 @@ void CodeGenerator::InsertArg(const VarTemplateDecl* stmt)
 
     InsertArg(templatedDecl);
 
+    SpecializationsState state{};
+
     for(OnceTrue first{}; const auto* spec : stmt->specializations()) {
         if(TSK_ExplicitSpecialization == spec->getSpecializationKind()) {
             continue;
         }
 
+        const auto args = spec->getTemplateArgs().asArray();
+
+        if(SkipSpecialization(*stmt, *spec, args, state)) {
+            continue;
+        }
+
         if(first) {
             mOutputFormatHelper.AppendNewLine();
         }
 
-        InsertArg(spec);
+        InsertSpecialization(*stmt, *spec, args, state);
     }
+
+    InsertSkippedSpecializations(*stmt, state);
 }
 //-----------------------------------------------------------------------------
 
@@ -471,6 +502,8 @@ void CodeGenerator::InsertArg(const ConditionalOperator* stmt)
 
 void CodeGenerator::InsertArg(const DoStmt* stmt)
 {
+    PushLoop(stmt);
+
     mOutputFormatHelper.Append(kwDoSpace);
 
     WrapInCompoundIfNeeded(stmt->getBody(), AddNewLineAfter::No);
@@ -555,6 +588,8 @@ void CodeGenerator::InsertArg(const SwitchStmt* stmt)
 
 void CodeGenerator::InsertArg(const WhileStmt* stmt)
 {
+    PushLoop(stmt);
+
     auto* rwStmt = const_cast<WhileStmt*>(stmt);
     auto* conditionVar{rwStmt->getConditionVariable()};
 
@@ -592,26 +627,57 @@ void CodeGenerator::InsertArg(const WhileStmt* stmt)
 }
 //-----------------------------------------------------------------------------
 
+///! The captures of a lambda closure type. Built once per closure type, as every \c FieldDecl of it needs a lookup.
+struct LambdaCaptureIndex
+{
+    llvm::DenseMap<const ValueDecl*, FieldDecl*>  captures{};
+    llvm::DenseMap<const FieldDecl*, std::string> names{};
+    FieldDecl*                                    thisCapture{};
+};
+
+///! Owned by pointer, as generating one lambda can build the index of another one and grow the map.
+/*constinit*/ static llvm::DenseMap<const CXXRecordDecl*, std::unique_ptr<LambdaCaptureIndex>> gLambdaCaptures{};
+//-----------------------------------------------------------------------------
+
+static const LambdaCaptureIndex& GetLambdaCaptureIndex(const CXXRecordDecl& cxxRecordDecl)
+{
+    static const ASTContext* capturesAST{};
+
+    // The records are only valid as long as their ASTContext.
+    if(const auto* ast = &GetGlobalAST(); ast != capturesAST) {
+        gLambdaCaptures.clear();
+        capturesAST = ast;
+    }
+
+    auto& index = gLambdaCaptures[&cxxRecordDecl];
+
+    if(nullptr == index) {
+        index = std::make_unique<LambdaCaptureIndex>();
+
+        cxxRecordDecl.getCaptureFields(index->captures, index->thisCapture);
+
+        for(const auto& [key, value] : index->captures) {
+            index->names.try_emplace(value, GetName(*key));
+        }
+    }
+
+    return *index;
+}
+//-----------------------------------------------------------------------------
+
 /// Get the name of a \c FieldDecl in case this \c FieldDecl is part of a lambda. The name has to be retrieved from the
 /// capture fields or can be \c __this.
 static std::optional<std::string> GetFieldDeclNameForLambda(const FieldDecl&     fieldDecl,
                                                             const CXXRecordDecl& cxxRecordDecl)
 {
     if(cxxRecordDecl.isLambda()) {
-        llvm::DenseMap<const ValueDecl*, FieldDecl*> captures{};
-
-        FieldDecl* thisCapture{};
+        const auto& index = GetLambdaCaptureIndex(cxxRecordDecl);
 
-        cxxRecordDecl.getCaptureFields(captures, thisCapture);
-
-        if(&fieldDecl == thisCapture) {
+        if(&fieldDecl == index.thisCapture) {
             return std::string{kwInternalThis};
-        } else {
-            for(const auto& [key, value] : captures) {
-                if(&fieldDecl == value) {
-                    return GetName(*key);
-                }
-            }
+
+        } else if(const auto it = index.names.find(&fieldDecl); it != index.names.end()) {
+            return it->second;
         }
     }
 
@@ -1088,28 +1154,43 @@ public:
 };
 //-----------------------------------------------------------------------------
 
-/*constinit*/ static SmallVector<std::pair<std::pair<const CXXRecordDecl*, const CXXRecordDecl*>, VarDecl*>, 10>
-                                            gVtables{};
+///! The vtables of all polymorphic classes in the order they are emitted to `__vtbl_array`.
+struct VtableRegistry
+{
+    using Key = std::pair<const CXXRecordDecl*, const CXXRecordDecl*>;
+
+    SmallVector<VarDecl*, 10>                 vtables{};
+    llvm::DenseMap<Key, int>                  positions{};       ///! (record, base) to position in `vtables`
+    llvm::DenseMap<const CXXRecordDecl*, int> firstPositions{};  ///! record to its first position in `vtables`
+};
+
+/*constinit*/ static VtableRegistry         gVtables{};
 /*constinit*/ static SmallVector<Expr*, 10> globalVarCtors{};
 /*constinit*/ static SmallVector<Expr*, 10> globalVarDtors{};
 //-----------------------------------------------------------------------------
 
 int GetGlobalVtablePos(const CXXRecordDecl* record, const CXXRecordDecl* recordB)
 {
-    auto iter = std::ranges::find_if(
-        gVtables, [&](const auto& e) { return (e.first.first == record) and (e.first.second == recordB); });
+    if(auto iter = gVtables.positions.find(VtableRegistry::Key{record, recordB}); iter != gVtables.positions.end()) {
+        return iter->second;
+    }
 
-    if(iter == gVtables.end()) {
-        iter = std::ranges::find_if(gVtables, [&](const auto& e) { return e.first.first == record; });
+    if(auto iter = gVtables.firstPositions.find(record); iter != gVtables.firstPositions.end()) {
+        return iter->second;
     }
 
-    return std::distance(gVtables.begin(), iter);
+    return static_cast<int>(gVtables.vtables.size());
 }
 //-----------------------------------------------------------------------------
 
 void PushVtableEntry(const CXXRecordDecl* record, const CXXRecordDecl* recordB, VarDecl* decl)
 {
-    gVtables.push_back({{record, recordB}, decl});
+    const auto pos = static_cast<int>(gVtables.vtables.size());
+
+    // The first entry of a record or a (record, base) pair wins.
+    gVtables.positions.try_emplace(VtableRegistry::Key{record, recordB}, pos);
+    gVtables.firstPositions.try_emplace(record, pos);
+    gVtables.vtables.push_back(decl);
 }
 //-----------------------------------------------------------------------------
 
@@ -1141,12 +1222,12 @@ std::string EmitGlobalVariableCtors()
     ofm.AppendNewLine();
     CodeGeneratorVariant cg{ofm};
 
-    if(gVtables.size()) {
+    if(gVtables.vtables.size()) {
         SmallVector<Expr*, 16> mInitExprs{};
 
-        for(auto& e : gVtables) {
-            cg->InsertArg(e.second);
-            mInitExprs.push_back(mkDeclRefExpr(e.second));
+        for(auto* vtable : gVtables.vtables) {
+            cg->InsertArg(vtable);
+            mInitExprs.push_back(mkDeclRefExpr(vtable));
         }
 
         ofm.AppendNewLine();
@@ -1178,6 +1259,202 @@ std::string EmitGlobalVariableCtors()
 }
 //-----------------------------------------------------------------------------
 
+///! Variables with static storage duration which cost at program start or exit, for \c --edu-show-static-init.
+/*constinit*/ static llvm::SetVector<const VarDecl*> gStaticInitVars{};
+//-----------------------------------------------------------------------------
+
+///! Variables without a constant initializer are initialized at runtime, static locals behind a guard.
+static bool HasDynamicInit(const VarDecl& var)
+{
+    return var.hasInit() and not IsEvaluatable(var);
+}
+//-----------------------------------------------------------------------------
+
+static bool HasExitTimeDtor(const VarDecl& var)
+{
+    return QualType::DK_cxx_destructor == var.needsDestruction(var.getASTContext());
+}
+//-----------------------------------------------------------------------------
+
+static void PushStaticInitVariable(const VarDecl& var)
+{
+    if(not var.hasGlobalStorage() or var.getDeclContext()->isDependentContext() or var.getType()->isDependentType() or
+       (var.hasInit() and var.getInit()->isValueDependent())) {
+        return;
+    }
+
+    if(HasDynamicInit(var) or HasExitTimeDtor(var)) {
+        gStaticInitVars.insert(&var);
+    }
+}
+//-----------------------------------------------------------------------------
+
+///! The function or constructor invoked by the initializer of \p var, if there is a single one.
+static const FunctionDecl* GetInitFunction(const VarDecl& var)
+{
+    const auto* init = var.getInit()->IgnoreImplicit();
+
+    if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(init)) {
+        return ctorExpr->getConstructor();
+
+    } else if(const auto* callExpr = dyn_cast_or_null<CallExpr>(init)) {
+        return callExpr->getDirectCallee();
+    }
+
+    return nullptr;
+}
+//-----------------------------------------------------------------------------
+
+std::string EmitStaticInitReport()
+{
+    std::string ret{};
+
+    if(not gStaticInitVars.empty()) {
+        ret.append("\n/* Static initialization:\n"sv);
+
+        for(const auto* var : gStaticInitVars) {
+            const auto& sm = GetSM(*var);
+            ret.append(StrCat("   "sv,
+                              GetName(*var),
+                              " ("sv,
+                              llvm::sys::path::filename(sm.getFilename(var->getLocation())),
+                              ":"sv,
+                              sm.getSpellingLineNumber(var->getLocation()),
+                              "): "sv));
+
+            if(not HasDynamicInit(*var)) {
+                ret.append("constant initialization"sv);
+
+            } else {
+                if(const auto* function = dyn_cast_or_null<FunctionDecl>(var->getParentFunctionOrMethod())) {
+                    ret.append(StrCat("guarded local static in "sv, GetName(*function)));
+                } else {
+                    ret.append("dynamic initialization"sv);
+                }
+
+                if(const auto* initFunction = GetInitFunction(*var)) {
+                    const auto name = initFunction->getQualifiedNameAsString();
+
+                    ret.append(StrCat(", calls "sv, name, ", constinit: not possible, "sv));
+
+                    if(initFunction->isConstexpr()) {
+                        ret.append("the arguments are not constant expressions"sv);
+                    } else {
+                        ret.append(StrCat(name, " is not constexpr"sv));
+                    }
+
+                } else {
+                    ret.append(", constinit: not possible, the initializer is not a constant expression"sv);
+                }
+            }
+
+            if(HasExitTimeDtor(*var)) {
+                ret.append(", destructor registered with atexit"sv);
+            }
+
+            ret.append("\n"sv);
+        }
+
+        ret.append("*/\n"sv);
+    }
+
+    gStaticInitVars.clear();
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
+///! Function-local statics which are initialized behind a guard, for \c --edu-show-static-guards.
+/*constinit*/ static llvm::SetVector<const VarDecl*> gGuardedStatics{};
+//-----------------------------------------------------------------------------
+
+///! Find a call to \p function somewhere in \p stmt.
+static const CallExpr* FindCallTo(const Stmt* stmt, const FunctionDecl& function)
+{
+    if(nullptr == stmt) {
+        return nullptr;
+    }
+
+    if(const auto* callExpr = dyn_cast_or_null<CallExpr>(stmt)) {
+        if(const auto* callee = callExpr->getDirectCallee();
+           callee and (callee->getCanonicalDecl() == function.getCanonicalDecl())) {
+            return callExpr;
+        }
+    }
+
+    for(const auto* child : stmt->children()) {
+        if(const auto* callExpr = FindCallTo(child, function)) {
+            return callExpr;
+        }
+    }
+
+    return nullptr;
+}
+//-----------------------------------------------------------------------------
+
+std::string EmitStaticGuardReport()
+{
+    std::string ret{};
+
+    if(not gGuardedStatics.empty()) {
+        ret.append("\n/* Guarded local statics:\n"sv);
+
+        for(const auto* var : gGuardedStatics) {
+            const auto* function = dyn_cast_or_null<FunctionDecl>(var->getParentFunctionOrMethod());
+            const auto& sm       = GetSM(*var);
+
+            ret.append(StrCat("   "sv, GetName(*var), " in "sv, GetName(*function), ": "sv));
+
+            // Each call pays at least the acquire-load of the guard, in a loop once per iteration.
+            const CallExpr* callInLoop{};
+            for(const auto* loop : gLoops) {
+                callInLoop = FindCallTo(loop, *function);
+
+                if(callInLoop) {
+                    break;
+                }
+            }
+
+            if(callInLoop) {
+                ret.append(StrCat("hot path, "sv,
+                                  GetName(*function),
+                                  " is called in a loop at line "sv,
+                                  sm.getSpellingLineNumber(callInLoop->getBeginLoc()),
+                                  ", "sv));
+            }
+
+            const auto* initFunction = GetInitFunction(*var);
+
+            if(initFunction and initFunction->isConstexpr()) {
+                ret.append(StrCat("constant initialization possible with constant arguments to "sv,
+                                  initFunction->getQualifiedNameAsString()));
+
+                if(HasExitTimeDtor(*var)) {
+                    ret.append(", the non-trivial destructor keeps the guard"sv);
+                }
+
+            } else if(initFunction) {
+                ret.append(StrCat("no constant initialization, "sv,
+                                  initFunction->getQualifiedNameAsString(),
+                                  " is not constexpr"sv));
+
+            } else {
+                ret.append("no constant initialization, the initializer is not a constant expression"sv);
+            }
+
+            ret.append("\n"sv);
+        }
+
+        ret.append("*/\n"sv);
+    }
+
+    gGuardedStatics.clear();
+    gLoops.clear();
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::LifetimeAddExtended(const VarDecl* vd, const ValueDecl* extending)
 {
     mLifeTimeTracker.AddExtended(vd, extending);
@@ -1268,6 +1545,93 @@ void CodeGenerator::InsertTemplateSpecializationHeader(const Decl& decl)
 }
 //-----------------------------------------------------------------------------
 
+///! The first subexpression of \p expr which keeps it from being evaluated at compile time.
+static const Expr& FindNonConstantExpr(const Expr& expr)
+{
+    for(const auto* child : expr.children()) {
+        if(const auto* childExpr = dyn_cast_or_null<Expr>(child);
+           childExpr and not childExpr->isValueDependent() and not childExpr->isEvaluatable(GetGlobalAST())) {
+            return FindNonConstantExpr(*childExpr);
+        }
+    }
+
+    return expr;
+}
+//-----------------------------------------------------------------------------
+
+static bool ContainsLambda(const Stmt* stmt)
+{
+    RETURN_FALSE_IF(nullptr == stmt);
+
+    return isa<LambdaExpr>(stmt) or ranges::any_of(stmt->children(), ContainsLambda);
+}
+//-----------------------------------------------------------------------------
+
+///! The part of \p expr which is left to run time. It is printed with Clang's printer, running a code generator on it
+///! would emit closure types a second time and repeat the registrations of the other options.
+static std::string GetRunTimeSplit(const Expr& expr)
+{
+    const auto& nonConstant = FindNonConstantExpr(expr);
+
+    // Clang prints the entire body of a lambda, the closure type is visible from the code generated for it.
+    if(ContainsLambda(&nonConstant)) {
+        return std::string{"run time"sv};
+    }
+
+    PrintingPolicy pp{GetGlobalAST().getLangOpts()};
+    pp.adjustForCPlusPlus();
+
+    std::string                ret{"run time: "sv};
+    ::llvm::raw_string_ostream stream{ret};
+    nonConstant.printPretty(stream, nullptr, pp);
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
+///! Whether \p expr is folded at compile time or left to run time, for \c --edu-show-consteval-split.
+static std::string GetConstevalSplit(const Expr& expr)
+{
+    if(expr.isValueDependent()) {
+        return {};
+    }
+
+    if(Expr::EvalResult result{}; expr.EvaluateAsRValue(result, GetGlobalAST()) and not result.HasSideEffects) {
+        return StrCat("compile time: "sv, result.Val.getAsString(GetGlobalAST(), expr.getType()));
+    }
+
+    return GetRunTimeSplit(expr);
+}
+//-----------------------------------------------------------------------------
+
+///! Whether the initializer of \p var is folded at compile time or left to run time. Variables with static storage
+///! duration are either constant or dynamically initialized.
+static std::string GetConstevalSplit(const VarDecl& var)
+{
+    const auto* init = var.getInit();
+
+    if((nullptr == init) or var.isImplicit() or isa<ParmVarDecl>(var) or var.getType()->isDependentType() or
+       var.getType()->isReferenceType() or init->isValueDependent()) {
+        return {};
+    }
+
+    // Default initialization with a trivial constructor does not initialize anything.
+    if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(init);
+       ctorExpr and ctorExpr->getConstructor()->isTrivial() and ctorExpr->getConstructor()->isDefaultConstructor()) {
+        return {};
+    }
+
+    const bool hasStaticStorage{var.hasGlobalStorage()};
+
+    if(const auto* value = GetEvaluatedValue(var)) {
+        return StrCat(ValueOr(hasStaticStorage, "constant initialization: "sv, "compile time: "sv),
+                      value->getAsString(GetGlobalAST(), var.getType()));
+    }
+
+    return StrCat(ValueOrDefault(hasStaticStorage, "dynamic initialization, "sv), GetRunTimeSplit(*init));
+}
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::InsertArg(const VarDecl* stmt)
 {
     if(auto* init = stmt->getInit();
@@ -1290,6 +1654,10 @@ void CodeGenerator::InsertArg(const VarDecl* stmt)
     LAMBDA_SCOPE_HELPER(VarDecl);
     UpdateCurrentPos(mCurrentVarDeclPos);
 
+    if(GetInsightsOptions().UseShowStaticInit) {
+        PushStaticInitVariable(*stmt);
+    }
+
     TemporaryDeclFinder temporaryFinder{*this, stmt->getInit()};
 
     if(InsertComma()) {
@@ -1322,6 +1690,12 @@ void CodeGenerator::InsertArg(const VarDecl* stmt)
     if(IsTrivialStaticClassVarDecl(*stmt)) {
         HandleLocalStaticNonTrivialClass(stmt);
 
+        if(GetInsightsOptions().UseShowConstevalSplit) {
+            if(const auto split = GetConstevalSplit(*stmt); not split.empty()) {
+                mOutputFormatHelper.AppendCommentNewLine(StrCat(GetName(*stmt), ": "sv, split));
+            }
+        }
+
     } else {
         if(InsertVarDecl(stmt)) {
             const auto desugaredType = GetType(GetDesugarType(stmt->getType()));
@@ -1473,6 +1847,13 @@ void CodeGenerator::InsertArg(const VarDecl* stmt)
             PushGlobalVariable(Assign(stmt, Int32(0)));
         }
 
+        if(GetInsightsOptions().UseShowConstevalSplit) {
+            if(const auto split = GetConstevalSplit(*stmt); not split.empty()) {
+                mOutputFormatHelper.Append(" "sv);
+                mOutputFormatHelper.AppendComment(split);
+            }
+        }
+
         if(stmt->isNRVOVariable()) {
             mOutputFormatHelper.Append(" /* NRVO variable */"sv);
         }
@@ -1632,8 +2013,22 @@ void CodeGenerator::InsertArg(const CoreturnStmt* stmt)
 }
 //-----------------------------------------------------------------------------
 
+///! Functions and records in the order they are shown, for \c --edu-show-exception-costs.
+/*constinit*/ static llvm::SetVector<const Decl*> gExceptionCostDecls{};
+//-----------------------------------------------------------------------------
+
+///! Functions in the order they are shown, for \c --edu-show-allocations.
+/*constinit*/ static llvm::SetVector<const FunctionDecl*> gAllocationFunctions{};
+//-----------------------------------------------------------------------------
+
+///! The function whose definition is currently generated. The HALO analysis searches it for the parents of a call.
+/*constinit*/ static const FunctionDecl* gCurrentFunction{};
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::InsertMethodBody(const FunctionDecl* stmt, const size_t posBeforeFunc)
 {
+    BackupAndRestore _{gCurrentFunction, stmt};
+
     auto IsPrimaryTemplate = [&] {
         // For now, don't transform the primary template of a coroutine
         if(const auto* cxxMethod = dyn_cast_or_null<CXXMethodDecl>(stmt)) {
@@ -1676,6 +2071,19 @@ void CodeGenerator::InsertMethodBody(const FunctionDecl* stmt, const size_t posB
                 body = mkCompoundStmt(Try(body, Catch(Call("std::terminate"sv, {}))));
             }
 
+            // Skip the members of closure types, they have no name to report them with.
+            if(const auto* method = dyn_cast_or_null<CXXMethodDecl>(stmt);
+               not IsPrimaryTemplate() and not stmt->isDependentContext() and not stmt->isImplicit() and
+               not(method and method->getParent()->isLambda())) {
+                if(GetInsightsOptions().UseShowExceptionCosts) {
+                    gExceptionCostDecls.insert(stmt);
+                }
+
+                if(GetInsightsOptions().UseShowAllocations) {
+                    gAllocationFunctions.insert(stmt);
+                }
+            }
+
             if(GetInsightsOptions().ShowLifetime) {
                 for(const auto* param : stmt->parameters()) {
                     auto       paramType = param->getType();
@@ -1704,12 +2112,12 @@ void CodeGenerator::InsertArg(const FunctionDecl* stmt)
         // Special handling for C++20's P0315 (lambda in unevaluated context). See p0315_2Test.cpp
         // We have to look for the lambda expression in the decltype.
         P0315Visitor dt{*this};
-        dt.TraverseType(stmt->getReturnType());
+        dt.TraverseTypeIfLambda(stmt->getReturnType());
 
         // The arguments can contain a lambda as well
         for(const auto& param : stmt->parameters()) {
             P0315Visitor dt{*this};
-            dt.TraverseType(param->getType());
+            dt.TraverseTypeIfLambda(param->getType());
         }
     }
 
@@ -1885,48 +2293,376 @@ void CodeGenerator::InsertTemplateParameters(const TemplateParameterList& list,
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ClassTemplateDecl* stmt)
+static std::string SpellTemplateArg(const TemplateArgument& arg)
 {
-    {
-        LAMBDA_SCOPE_HELPER(Decltype);  // Needed for P0315Checker
-        mLambdaStack.back().setInsertName(true);
+    OutputFormatHelper   ofm{};
+    CodeGeneratorVariant cg{ofm};
+    cg->InsertTemplateArg(arg);
 
-        InsertTemplateParameters(*stmt->getTemplateParameters());
+    return ofm.GetString();
+}
+//-----------------------------------------------------------------------------
+
+///! Replace each spelled template argument in \p code by a placeholder for its index. Two specializations with the
+///! same normalized code differ only in their template arguments.
+static std::string NormalizeSpecializationCode(std::string_view code, ArrayRef<TemplateArgument> args)
+{
+    SmallVector<std::pair<std::string, size_t>, 8> spellings{};
+
+    for(size_t idx{}; const auto& arg : args) {
+        if(TemplateArgument::Pack == arg.getKind()) {
+            for(const auto& packArg : arg.pack_elements()) {
+                spellings.emplace_back(SpellTemplateArg(packArg), idx++);
+            }
+        } else {
+            spellings.emplace_back(SpellTemplateArg(arg), idx++);
+        }
     }
 
-    InsertArg(stmt->getTemplatedDecl());
+    // The longest spelling must win, `int *` before `int`.
+    ranges::stable_sort(spellings, [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
 
-    SmallVector<const ClassTemplateSpecializationDecl*, 10> specializations{};
+    auto isIdentChar = [](char c) { return llvm::isAlnum(c) or ('_' == c); };
 
-    // XXX C++23: replace with filter and ranges::to<>
-    for(const auto* spec : stmt->specializations()) {
-        // Explicit specializations and instantiations will appear later in the AST as dedicated node. Don't
-        // generate code for them now, otherwise they are there twice.
-        if(TSK_ImplicitInstantiation == spec->getSpecializationKind()) {
-            specializations.push_back(spec);
+    auto matchesAt = [&](std::string_view spelling, size_t pos) {
+        if(spelling.empty() or not code.substr(pos).starts_with(spelling)) {
+            return false;
         }
-    }
 
-    // Sort specializations by POI to make dependent specializations work.
-    ranges::sort(specializations,
-                 [](const ClassTemplateSpecializationDecl* a, const ClassTemplateSpecializationDecl* b) {
-                     return a->getPointOfInstantiation() < b->getPointOfInstantiation();
-                 });
+        const size_t end = pos + spelling.size();
 
-    for(const auto* spec : specializations) {
-        InsertArg(spec);
+        // Only match complete tokens, `int` must not match inside `print`.
+        return not(((0 < pos) and isIdentChar(code[pos - 1]) and isIdentChar(spelling.front())) or
+                   ((end < code.size()) and isIdentChar(code[end]) and isIdentChar(spelling.back())));
+    };
+
+    std::string ret{};
+    ret.reserve(code.size());
+
+    // A single pass, a placeholder must never be matched by the spelling of another argument.
+    for(size_t pos{}; pos < code.size();) {
+        if(const auto match =
+               ranges::find_if(spellings, [&](const auto& spelling) { return matchesAt(spelling.first, pos); });
+           match != spellings.end()) {
+            ret.append(StrCat("\x01"sv, match->second, "\x01"sv));
+            pos += match->first.size();
+
+        } else {
+            ret.push_back(code[pos]);
+            ++pos;
+        }
     }
+
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ParenListExpr* stmt)
+static std::string GetSpecializationName(const TemplateDecl& primary, ArrayRef<TemplateArgument> args)
 {
-    for(OnceFalse needsComma{}; const auto& expr : stmt->children()) {
-        mOutputFormatHelper.AppendComma(needsComma);
+    std::string name{StrCat(GetName(primary), "<"sv)};
 
-        InsertArg(expr);
+    for(OnceFalse needsComma{}; const auto& arg : args) {
+        if(needsComma) {
+            name.append(", "sv);
+        }
+
+        name.append(SpellTemplateArg(arg));
     }
-}
+
+    name.append(">"sv);
+
+    return name;
+}
+//-----------------------------------------------------------------------------
+
+///! The specializations of one primary template for \c --edu-show-instantiation-stats.
+struct InstantiationStats
+{
+    ///! Name, generated declarations and statements and point of instantiation of each specialization.
+    SmallVector<std::tuple<std::string, uint64_t, SourceLocation>, 4> specializations{};
+    llvm::SmallPtrSet<const Decl*, 4>                                 seen{};
+    uint64_t                                                          nodes{};
+};
+
+/*constinit*/ static llvm::MapVector<const TemplateDecl*, InstantiationStats> gInstantiationStats{};
+//-----------------------------------------------------------------------------
+
+static uint64_t CountStmts(const Stmt* stmt)
+{
+    if(nullptr == stmt) {
+        return 0;
+    }
+
+    uint64_t ret{1};
+
+    for(const auto* child : stmt->children()) {
+        ret += CountStmts(child);
+    }
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
+///! The declarations and statements a specialization adds to the program. For a class these are its members, together
+///! with the statements of the instantiated member functions and member initializers.
+static uint64_t CountGeneratedNodes(const Decl& decl)
+{
+    if(const auto* function = dyn_cast_or_null<FunctionDecl>(&decl)) {
+        return 1 + CountStmts(function->getBody());
+
+    } else if(const auto* var = dyn_cast_or_null<VarDecl>(&decl)) {
+        return 1 + CountStmts(var->getInit());
+
+    } else if(const auto* field = dyn_cast_or_null<FieldDecl>(&decl)) {
+        return 1 + CountStmts(field->getInClassInitializer());
+
+    } else if(const auto* record = dyn_cast_or_null<CXXRecordDecl>(&decl)) {
+        uint64_t ret{1};
+
+        // The implicit members, like the injected class name, are not part of the generated code.
+        for(const auto* member : record->decls()) {
+            if(not member->isImplicit()) {
+                ret += CountGeneratedNodes(*member);
+            }
+        }
+
+        return ret;
+    }
+
+    return 0;
+}
+//-----------------------------------------------------------------------------
+
+template<typename T>
+static void RecordInstantiation(const TemplateDecl& primary, const T& spec, ArrayRef<TemplateArgument> args)
+{
+    RETURN_IF(not GetInsightsOptions().UseShowInstantiationStats);
+
+    auto& stats = gInstantiationStats[cast<TemplateDecl>(primary.getCanonicalDecl())];
+
+    // The same specialization can be generated more than once, e.g. with --edu-show-cfront.
+    RETURN_IF(not stats.seen.insert(&spec).second);
+
+    const auto nodes = CountGeneratedNodes(spec);
+    stats.nodes += nodes;
+    stats.specializations.emplace_back(GetSpecializationName(primary, args), nodes, spec.getPointOfInstantiation());
+}
+//-----------------------------------------------------------------------------
+
+std::string EmitInstantiationStats()
+{
+    std::string ret{};
+
+    if(not gInstantiationStats.empty()) {
+        SmallVector<const std::pair<const TemplateDecl*, InstantiationStats>*, 16> templates{};
+
+        for(const auto& entry : gInstantiationStats) {
+            templates.push_back(&entry);
+        }
+
+        // The most expensive templates first, they are the candidates for type-erasure or explicit instantiation.
+        ranges::stable_sort(templates, [](const auto* a, const auto* b) {
+            return std::tuple{a->second.nodes, a->second.specializations.size()} >
+                   std::tuple{b->second.nodes, b->second.specializations.size()};
+        });
+
+        ret.append("\n/* Instantiation statistics, most generated declarations and statements first:\n"sv);
+
+        for(const auto* entry : templates) {
+            const auto& [primary, stats] = *entry;
+            const auto& sm               = GetSM(*primary);
+            const auto  count            = stats.specializations.size();
+
+            ret.append(StrCat("   "sv,
+                              GetName(*primary),
+                              ": "sv,
+                              count,
+                              (1 == count) ? " specialization, "sv : " specializations, "sv,
+                              stats.nodes,
+                              " declarations and statements, "sv,
+                              stats.nodes / count,
+                              " on average\n"sv));
+
+            for(const auto& [name, nodes, instLoc] : stats.specializations) {
+                ret.append(StrCat("     "sv, name, ": "sv, nodes, " declarations and statements"sv));
+
+                if(instLoc.isValid()) {
+                    ret.append(StrCat(", instantiated from: "sv,
+                                      llvm::sys::path::filename(sm.getFilename(sm.getSpellingLoc(instLoc))),
+                                      ":"sv,
+                                      sm.getSpellingLineNumber(instLoc)));
+                }
+
+                ret.append("\n"sv);
+            }
+        }
+
+        ret.append("*/\n"sv);
+    }
+
+    gInstantiationStats.clear();
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
+template<typename T>
+bool CodeGenerator::SkipSpecialization(const TemplateDecl&        primary,
+                                       const T&                   spec,
+                                       ArrayRef<TemplateArgument> args,
+                                       SpecializationsState&      state)
+{
+    // Every specialization passes here, whether it is shown or not.
+    RecordInstantiation(primary, spec, args);
+
+    const auto maxSpecializations = GetInsightsOptions().MaxSpecializations;
+    RETURN_FALSE_IF((0 == maxSpecializations) or (state.shown < maxSpecializations));
+
+    state.notShown.emplace_back(GetSpecializationName(primary, args), spec.getPointOfInstantiation());
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertSkippedSpecializations(const TemplateDecl& primary, const SpecializationsState& state)
+{
+    RETURN_IF(state.notShown.empty());
+
+    mOutputFormatHelper.AppendCommentNewLine(GetName(primary),
+                                             ": "sv,
+                                             state.notShown.size(),
+                                             ValueOr(1 == state.notShown.size(),
+                                                     " more specialization not shown (--max-specializations="sv,
+                                                     " more specializations not shown (--max-specializations="sv),
+                                             GetInsightsOptions().MaxSpecializations,
+                                             ")"sv);
+
+    for(const auto& [name, instLoc] : state.notShown) {
+        InsertInstantiationPoint(GetSM(primary), instLoc, StrCat(name, " instantiated from: "sv));
+    }
+}
+//-----------------------------------------------------------------------------
+
+template<typename T>
+bool CodeGenerator::InsertSpecialization(const TemplateDecl&        primary,
+                                         const T&                   spec,
+                                         ArrayRef<TemplateArgument> args,
+                                         SpecializationsState&      state)
+{
+    ++state.shown;
+
+    if(not GetInsightsOptions().CollapseIdenticalSpecializations) {
+        InsertArg(&spec);
+        return true;
+    }
+
+    OutputFormatHelper ofm{};
+    ofm.SetIndent(mOutputFormatHelper, OutputFormatHelper::SkipIndenting::Yes);
+
+    {
+        CodeGeneratorVariant cg{ofm};
+        cg->InsertArg(&spec);
+    }
+
+    std::string_view code{ofm.GetString()};
+
+    // The point of instantiation differs for every specialization, it is not part of the code.
+    static constexpr auto instantiationPointPrefix{"/* First instantiated from: "sv};
+    size_t                codeStart{};
+
+    for(auto lineStart = code.find_first_not_of(' ', codeStart);
+        (std::string_view::npos != lineStart) and code.substr(lineStart).starts_with(instantiationPointPrefix);
+        lineStart = code.find_first_not_of(' ', codeStart)) {
+        const auto eol = code.find('\n', lineStart);
+
+        if(std::string_view::npos == eol) {
+            break;
+        }
+
+        codeStart = eol + 1;
+    }
+
+    // Keep the indentation of the first line of code with the instantiation point.
+    codeStart = std::min(code.find_first_not_of(' ', codeStart), code.size());
+
+    const auto spelledName{GetSpecializationName(primary, args)};
+
+    const auto [it, inserted] =
+        state.seenCode.try_emplace(NormalizeSpecializationCode(code.substr(codeStart), args), spelledName);
+
+    if(inserted) {
+        mOutputFormatHelper.Append(code);
+        return true;
+    }
+
+    std::string withArgs{};
+    const auto* params = primary.getTemplateParameters();
+
+    for(OnceFalse needsComma{}; const auto idx : NumberIterator{std::min<size_t>(params->size(), args.size())}) {
+        if(needsComma) {
+            withArgs.append(", "sv);
+        }
+
+        withArgs.append(StrCat(GetName(*params->getParam(idx)), " = "sv, SpellTemplateArg(args[idx])));
+    }
+
+    mOutputFormatHelper.Append(code.substr(0, codeStart));
+    mOutputFormatHelper.AppendCommentNewLine(spelledName, ": same as "sv, it->second, " with "sv, withArgs);
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ClassTemplateDecl* stmt)
+{
+    {
+        LAMBDA_SCOPE_HELPER(Decltype);  // Needed for P0315Checker
+        mLambdaStack.back().setInsertName(true);
+
+        InsertTemplateParameters(*stmt->getTemplateParameters());
+    }
+
+    InsertArg(stmt->getTemplatedDecl());
+
+    SmallVector<const ClassTemplateSpecializationDecl*, 10> specializations{};
+
+    // XXX C++23: replace with filter and ranges::to<>
+    for(const auto* spec : stmt->specializations()) {
+        // Explicit specializations and instantiations will appear later in the AST as dedicated node. Don't
+        // generate code for them now, otherwise they are there twice.
+        if(TSK_ImplicitInstantiation == spec->getSpecializationKind()) {
+            specializations.push_back(spec);
+        }
+    }
+
+    // Sort specializations by POI to make dependent specializations work.
+    ranges::sort(specializations,
+                 [](const ClassTemplateSpecializationDecl* a, const ClassTemplateSpecializationDecl* b) {
+                     return a->getPointOfInstantiation() < b->getPointOfInstantiation();
+                 });
+
+    SpecializationsState state{};
+
+    for(const auto* spec : specializations) {
+        const auto args = spec->getTemplateArgs().asArray();
+
+        if(not SkipSpecialization(*stmt, *spec, args, state)) {
+            InsertSpecialization(*stmt, *spec, args, state);
+        }
+    }
+
+    InsertSkippedSpecializations(*stmt, state);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ParenListExpr* stmt)
+{
+    for(OnceFalse needsComma{}; const auto& expr : stmt->children()) {
+        mOutputFormatHelper.AppendComma(needsComma);
+
+        InsertArg(expr);
+    }
+}
 //-----------------------------------------------------------------------------
 
 /// Fill the values of a constant array.
@@ -2024,7 +2760,7 @@ void CodeGenerator::InsertConstructorExpr(const auto* stmt)
         CONDITIONAL_LAMBDA_SCOPE_HELPER(Decltype, not isa<DecltypeType>(stmt->getType()))
 
         P0315Visitor dt{*this};
-        dt.TraverseType(stmt->getType());
+        dt.TraverseTypeIfLambda(stmt->getType());
 
         if(not mLambdaStack.empty()) {
             for(const auto& e : mLambdaStack) {
@@ -2045,1375 +2781,3395 @@ void CodeGenerator::InsertConstructorExpr(const auto* stmt)
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXConstructExpr* stmt)
-{
-    InsertConstructorExpr(stmt);
-}
+///! Non-trivial copies from expiring values found by \c --edu-show-copies, per function in order of appearance.
+/*constinit*/ static llvm::MapVector<const FunctionDecl*, unsigned> gCopiesPerFunction{};
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXUnresolvedConstructExpr* stmt)
+std::string EmitCopySummary()
 {
-    BackupAndRestore _{mNoEmptyInitList, NoEmptyInitList::Yes};
+    std::string ret{};
 
-    InsertConstructorExpr(stmt);
+    if(not gCopiesPerFunction.empty()) {
+        ret.append("\n/* Hidden copies per function:\n"sv);
+
+        for(const auto& [function, copies] : gCopiesPerFunction) {
+            ret.append(StrCat("   "sv, GetName(*function), ": "sv, copies, "\n"sv));
+        }
+
+        ret.append("*/\n"sv);
+    }
+
+    gCopiesPerFunction.clear();
+
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const UnresolvedMemberExpr* stmt)
+static std::string CountCopy(const DeclContext* context, QualType type, std::string_view reason)
 {
-    // InsertArg(stmt->getBase());
-    // const std::string op{};  // stmt->isArrow() ? "->" : "."};
+    if(context) {
+        context = context->getNonClosureAncestor();
+    }
 
-    // mOutputFormatHelper.Append(op, stmt->getMemberNameInfo().getAsString());
-    mOutputFormatHelper.Append(stmt->getMemberNameInfo().getAsString());
+    for(; context and not isa<FunctionDecl>(context); context = context->getParent()) {
+    }
 
-    if(stmt->getNumTemplateArgs()) {
-        InsertTemplateArgs(*stmt);
+    if(context) {
+        ++gCopiesPerFunction[cast<FunctionDecl>(context)];
     }
+
+    return StrCat(" /* copy: "sv, GetGlobalAST().getTypeSizeInChars(type), " bytes, "sv, reason, " */"sv);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const PackExpansionExpr* stmt)
+///! A by-value capture is only worth a look if the captured type is larger than two pointers.
+static std::string GetCaptureCopyAnnotation(const CXXRecordDecl& closure, const Expr* captureInit)
 {
-    InsertArg(stmt->getPattern());
-    mOutputFormatHelper.Append(kwElipsisSpace);
+    const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(captureInit ? captureInit->IgnoreImplicit() : nullptr);
+
+    if((nullptr == ctorExpr) or not ctorExpr->getConstructor()->isCopyConstructor() or
+       ctorExpr->getConstructor()->isTrivial()) {
+        return {};
+    }
+
+    if(const auto& ctx = GetGlobalAST(); ctx.getTypeSize(ctorExpr->getType()) <= (2 * ctx.getTypeSize(ctx.VoidPtrTy))) {
+        return {};
+    }
+
+    return CountCopy(closure.getDeclContext(), ctorExpr->getType(), "by-value capture"sv);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXFoldExpr* stmt)
+///! The uses of the local variables of a function, collected in a single pass over its body.
+struct LocalUses
 {
-    auto operatorStr = BinaryOperator::getOpcodeStr(stmt->getOperator());
+    llvm::DenseMap<const VarDecl*, const DeclRefExpr*> lastUse{};
+    ///! Uses inside a loop which does not contain the declaration of the variable, another iteration can follow.
+    llvm::SmallPtrSet<const DeclRefExpr*, 8> inLoop{};
+};
+//-----------------------------------------------------------------------------
 
-    WrapInParens([&] {
-        // We have a binary NNN fold. If init is nullptr, then it is a unary NNN fold.
-        const auto* init = stmt->getInit();
+static void CollectLocalUses(const Stmt* stmt, const Stmt* loop, const SourceManager& sm, LocalUses& uses)
+{
+    if(nullptr == stmt) {
+        return;
+    }
 
-        if(stmt->isLeftFold()) {
-            if(init) {
-                InsertArg(init);
-                mOutputFormatHelper.Append(" "sv, operatorStr, " "sv);
+    if(const auto* ref = dyn_cast_or_null<DeclRefExpr>(stmt)) {
+        if(const auto* var = dyn_cast_or_null<VarDecl>(ref->getDecl()); var and var->hasLocalStorage()) {
+            if(auto& last = uses.lastUse[var];
+               (nullptr == last) or sm.isBeforeInTranslationUnit(last->getBeginLoc(), ref->getBeginLoc())) {
+                last = ref;
             }
 
-            mOutputFormatHelper.Append(kwElipsisSpace, operatorStr, " "sv);
+            // Only the innermost loop matters, the outer ones contain the declaration if it does.
+            if(loop and (sm.isBeforeInTranslationUnit(var->getLocation(), loop->getBeginLoc()) or
+                         sm.isBeforeInTranslationUnit(loop->getEndLoc(), var->getLocation()))) {
+                uses.inLoop.insert(ref);
+            }
         }
+    }
 
-        InsertArg(stmt->getPattern());
-
-        if(stmt->isRightFold()) {
-            mOutputFormatHelper.Append(" "sv, operatorStr, " "sv, kwElipsis);
+    if(isa<ForStmt, WhileStmt, DoStmt, CXXForRangeStmt>(stmt)) {
+        loop = stmt;
+    }
 
-            if(init) {
-                mOutputFormatHelper.Append(" "sv, operatorStr, " "sv);
-                InsertArg(init);
-            }
-        }
-    });
+    for(const auto* child : stmt->children()) {
+        CollectLocalUses(child, loop, sm, uses);
+    }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const PackIndexingExpr* stmt)
-{
-    if(stmt->isFullySubstituted()) {
-        const auto* constExpr = dyn_cast_or_null<ConstantExpr>(stmt->getIndexExpr());
-
-        mOutputFormatHelper.Append(BuildInternalVarName(GetName(*stmt->getPackDecl())),
-                                   constExpr->getAPValueResult().getInt());
+///! The uses of the locals per function, each body is walked only once.
+/*constinit*/ static llvm::DenseMap<const FunctionDecl*, LocalUses> gLocalUses{};
+//-----------------------------------------------------------------------------
 
-    } else {
-        mOutputFormatHelper.Append(GetName(*stmt->getPackDecl()), "...[");
+static const LocalUses& GetLocalUses(const FunctionDecl& function)
+{
+    auto [it, inserted] = gLocalUses.try_emplace(&function);
 
-        InsertArg(stmt->getIndexExpr());
-        mOutputFormatHelper.Append("]");
+    if(inserted) {
+        CollectLocalUses(function.getBody(), nullptr, GetSM(function), it->second);
     }
+
+    return it->second;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXInheritedCtorInitExpr* stmt)
+///! The local, non-reference variable \p source names, looking through casts and \c std::move.
+static const DeclRefExpr* GetNamedLocal(const Expr* source)
 {
-    const auto& constructorDecl = *stmt->getConstructor();
+    source = source->IgnoreParenCasts();
 
-    mOutputFormatHelper.Append(GetName(GetDesugarType(stmt->getType()), Unqualified::Yes));
-    WrapInParens([&]() {
-        mOutputFormatHelper.AppendParameterList(constructorDecl.parameters(),
-                                                OutputFormatHelper::NameOnly::Yes,
-                                                OutputFormatHelper::GenMissingParamName::Yes);
-    });
-}
-//-----------------------------------------------------------------------------
+    if(const auto* callExpr = dyn_cast_or_null<CallExpr>(source); callExpr and callExpr->isCallToStdMove()) {
+        source = callExpr->getArg(0)->IgnoreParenCasts();
+    }
 
-bool CodeGenerator::InsideDecltype() const
-{
-    return (not mLambdaStack.empty()) and (LambdaCallerType::Decltype == mLambdaStack.back().callerType());
-}
-//-----------------------------------------------------------------------------
+    const auto* ref = dyn_cast_or_null<DeclRefExpr>(source);
+    const auto* var = ref ? dyn_cast_or_null<VarDecl>(ref->getDecl()) : nullptr;
 
-void CodeGenerator::InsertArg(const CXXPseudoDestructorExpr* stmt)
-{
-    InsertArg(stmt->getBase());
+    if((nullptr == var) or not var->hasLocalStorage() or var->getType()->isReferenceType()) {
+        return nullptr;
+    }
 
-    mOutputFormatHelper.Append(ArrowOrDot(stmt->isArrow()), "~", GetName(stmt->getDestroyedType()));
+    return ref;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXMemberCallExpr* stmt)
+///! The local variable \p source refers to, if this is its last use.
+static const VarDecl* GetExpiringLocal(const Expr* source)
 {
-    CONDITIONAL_LAMBDA_SCOPE_HELPER(MemberCallExpr, not InsideDecltype())
+    const auto* ref = dyn_cast_or_null<DeclRefExpr>(source->IgnoreParenImpCasts());
 
-    InsertArg(stmt->getCallee());
+    if((nullptr == ref) or (GetNamedLocal(ref) != ref)) {
+        return nullptr;
+    }
 
-    WrapInParens([&]() { ForEachArg(stmt->arguments(), [&](const auto& arg) { InsertArg(arg); }); });
+    const auto* var = cast<VarDecl>(ref->getDecl());
+
+    if(const auto* function = dyn_cast_or_null<FunctionDecl>(var->getParentFunctionOrMethod())) {
+        if(const auto& uses = GetLocalUses(*function);
+           (uses.lastUse.lookup(var) == ref) and not uses.inLoop.contains(ref)) {
+            return var;
+        }
+    }
+
+    return nullptr;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ParenExpr* stmt)
+void CodeGenerator::InsertCopyAnnotation(const CXXConstructExpr& stmt)
 {
-    WrapInParens([&]() { InsertArg(stmt->getSubExpr()); });
+    const auto* ctor = stmt.getConstructor();
+    RETURN_IF(not ctor->isCopyConstructor() or ctor->isTrivial() or (0 == stmt.getNumArgs()));
+
+    if(mRangeForLoopVar and mRangeForLoopVar->getInit() and (mRangeForLoopVar->getInit()->IgnoreImplicit() == &stmt)) {
+        mOutputFormatHelper.Append(
+            CountCopy(mRangeForLoopVar->getDeclContext(), stmt.getType(), "by-value range-for variable"sv));
+
+        return;
+    }
+
+    const auto* source = stmt.getArg(0);
+    const auto* ref    = GetNamedLocal(source);
+
+    // A return is always the last use of a local, an xvalue was explicitly given up by the user.
+    if(ref and (mCurrentReturnPos.has_value() or source->isXValue())) {
+        const auto* var    = cast<VarDecl>(ref->getDecl());
+        const auto  kind   = ValueOr(mCurrentReturnPos.has_value(), "return of local '"sv, "xvalue of local '"sv);
+        const auto  reason = StrCat(kind, GetName(*var), "'"sv);
+
+        mOutputFormatHelper.Append(CountCopy(var->getDeclContext(), stmt.getType(), reason));
+
+    } else if(const auto* var = GetExpiringLocal(source)) {
+        const auto reason = StrCat("last use of local '"sv, GetName(*var), "'"sv);
+
+        mOutputFormatHelper.Append(CountCopy(var->getDeclContext(), stmt.getType(), reason));
+    }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXParenListInitExpr* stmt)
+void CodeGenerator::InsertCopyAnnotation(const CXXOperatorCallExpr& stmt)
 {
-    WrapInParens([&]() { ForEachArg(stmt->getInitExprs(), [&](const auto& init) { InsertArg(init); }); });
+    const auto* method = dyn_cast_or_null<CXXMethodDecl>(stmt.getCalleeDecl());
+    RETURN_IF((nullptr == method) or not method->isCopyAssignmentOperator() or method->isTrivial() or
+              (2 != stmt.getNumArgs()));
+
+    const auto* source = stmt.getArg(1);
+
+    if(const auto* ref = GetNamedLocal(source); ref and source->isXValue()) {
+        const auto* var    = cast<VarDecl>(ref->getDecl());
+        const auto  reason = StrCat("assignment from an xvalue of local '"sv, GetName(*var), "'"sv);
+
+        mOutputFormatHelper.Append(CountCopy(var->getDeclContext(), source->getType(), reason));
+
+    } else if(const auto* var = GetExpiringLocal(source)) {
+        const auto reason = StrCat("assignment from last use of local '"sv, GetName(*var), "'"sv);
+
+        mOutputFormatHelper.Append(CountCopy(var->getDeclContext(), source->getType(), reason));
+    }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const UnaryOperator* stmt)
+void CodeGenerator::InsertArg(const CXXConstructExpr* stmt)
 {
-    StringRef  opCodeName = UnaryOperator::getOpcodeStr(stmt->getOpcode());
-    const bool insertBefore{not stmt->isPostfix()};
+    InsertConstructorExpr(stmt);
 
-    if(insertBefore) {
-        mOutputFormatHelper.Append(opCodeName);
+    if(GetInsightsOptions().UseShowCopies) {
+        InsertCopyAnnotation(*stmt);
     }
+}
+//-----------------------------------------------------------------------------
 
-    InsertArg(stmt->getSubExpr());
+void CodeGenerator::InsertArg(const CXXUnresolvedConstructExpr* stmt)
+{
+    BackupAndRestore _{mNoEmptyInitList, NoEmptyInitList::Yes};
 
-    if(not insertBefore) {
-        mOutputFormatHelper.Append(opCodeName);
-    }
+    InsertConstructorExpr(stmt);
 }
-//-------------	----------------------------------------------------------------
+//-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const StringLiteral* stmt)
+void CodeGenerator::InsertArg(const UnresolvedMemberExpr* stmt)
 {
-    StringStream stream{};
-    stream.Print(*stmt);
+    // InsertArg(stmt->getBase());
+    // const std::string op{};  // stmt->isArrow() ? "->" : "."};
 
-    mOutputFormatHelper.Append(stream.str());
+    // mOutputFormatHelper.Append(op, stmt->getMemberNameInfo().getAsString());
+    mOutputFormatHelper.Append(stmt->getMemberNameInfo().getAsString());
+
+    if(stmt->getNumTemplateArgs()) {
+        InsertTemplateArgs(*stmt);
+    }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ArrayInitIndexExpr* stmt)
+void CodeGenerator::InsertArg(const PackExpansionExpr* stmt)
 {
-    Error(stmt, "ArrayInitIndexExpr should not be reached in CodeGenerator");
+    InsertArg(stmt->getPattern());
+    mOutputFormatHelper.Append(kwElipsisSpace);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ArraySubscriptExpr* stmt)
+void CodeGenerator::InsertArg(const CXXFoldExpr* stmt)
 {
-    if((not GetInsightsOptions().UseAltArraySubscriptionSyntax) or stmt->getLHS()->isLValue()) {
-        InsertArg(stmt->getLHS());
+    auto operatorStr = BinaryOperator::getOpcodeStr(stmt->getOperator());
 
-        mOutputFormatHelper.Append('[');
-        InsertArg(stmt->getRHS());
-        mOutputFormatHelper.Append(']');
-    } else {
+    WrapInParens([&] {
+        // We have a binary NNN fold. If init is nullptr, then it is a unary NNN fold.
+        const auto* init = stmt->getInit();
 
-        mOutputFormatHelper.Append("(*("sv);
-        InsertArg(stmt->getLHS());
-        mOutputFormatHelper.Append(" + "sv);
+        if(stmt->isLeftFold()) {
+            if(init) {
+                InsertArg(init);
+                mOutputFormatHelper.Append(" "sv, operatorStr, " "sv);
+            }
 
-        InsertArg(stmt->getRHS());
-        mOutputFormatHelper.Append("))"sv);
+            mOutputFormatHelper.Append(kwElipsisSpace, operatorStr, " "sv);
+        }
+
+        InsertArg(stmt->getPattern());
+
+        if(stmt->isRightFold()) {
+            mOutputFormatHelper.Append(" "sv, operatorStr, " "sv, kwElipsis);
+
+            if(init) {
+                mOutputFormatHelper.Append(" "sv, operatorStr, " "sv);
+                InsertArg(init);
+            }
+        }
+    });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const PackIndexingExpr* stmt)
+{
+    if(stmt->isFullySubstituted()) {
+        const auto* constExpr = dyn_cast_or_null<ConstantExpr>(stmt->getIndexExpr());
+
+        mOutputFormatHelper.Append(BuildInternalVarName(GetName(*stmt->getPackDecl())),
+                                   constExpr->getAPValueResult().getInt());
+
+    } else {
+        mOutputFormatHelper.Append(GetName(*stmt->getPackDecl()), "...[");
+
+        InsertArg(stmt->getIndexExpr());
+        mOutputFormatHelper.Append("]");
     }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ArrayInitLoopExpr* stmt)
+void CodeGenerator::InsertArg(const CXXInheritedCtorInitExpr* stmt)
 {
-    WrapInCurlys([&]() {
-        const uint64_t size = stmt->getArraySize().getZExtValue();
+    const auto& constructorDecl = *stmt->getConstructor();
 
-        ForEachArg(NumberIterator(size), [&](const auto& i) {
-            ArrayInitCodeGenerator codeGenerator{mOutputFormatHelper, i};
-            codeGenerator.InsertArg(stmt->getSubExpr());
-        });
+    mOutputFormatHelper.Append(GetName(GetDesugarType(stmt->getType()), Unqualified::Yes));
+    WrapInParens([&]() {
+        mOutputFormatHelper.AppendParameterList(constructorDecl.parameters(),
+                                                OutputFormatHelper::NameOnly::Yes,
+                                                OutputFormatHelper::GenMissingParamName::Yes);
     });
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const OpaqueValueExpr* stmt)
+bool CodeGenerator::InsideDecltype() const
 {
-    InsertArg(stmt->getSourceExpr());
+    return (not mLambdaStack.empty()) and (LambdaCallerType::Decltype == mLambdaStack.back().callerType());
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CallExpr* stmt)
+void CodeGenerator::InsertArg(const CXXPseudoDestructorExpr* stmt)
 {
-    const bool insideDecltype{InsideDecltype()};
+    InsertArg(stmt->getBase());
 
-    CONDITIONAL_LAMBDA_SCOPE_HELPER(CallExpr, not insideDecltype)
-    if(insideDecltype) {
-        mLambdaStack.back().setInsertName(true);
-    }
+    mOutputFormatHelper.Append(ArrowOrDot(stmt->isArrow()), "~", GetName(stmt->getDestroyedType()));
+}
+//-----------------------------------------------------------------------------
 
-    UpdateCurrentPos(mCurrentCallExprPos);
+static void FindDeclRefs(const Stmt* stmt, const VarDecl& var, SmallVectorImpl<const DeclRefExpr*>& refs)
+{
+    RETURN_IF(nullptr == stmt);
 
-    InsertArg(stmt->getCallee());
+    if(const auto* ref = dyn_cast_or_null<DeclRefExpr>(stmt); ref and (ref->getDecl() == &var)) {
+        refs.push_back(ref);
+    }
 
-    if(const auto* declRefExpr = dyn_cast_or_null<DeclRefExpr>(stmt->getCallee()->IgnoreImpCasts())) {
-        if(const auto* fd = dyn_cast_or_null<FunctionDecl>(declRefExpr->getDecl())) {
-            if((not declRefExpr->getNumTemplateArgs() and GetInsightsOptions().ShowAllCallExprTemplateParameters) or
-               isa<UserDefinedLiteral>(stmt)) {
-                InsertTemplateArgs(*fd);
-            }
-        }
+    for(const auto* child : stmt->children()) {
+        FindDeclRefs(child, var, refs);
     }
+}
+//-----------------------------------------------------------------------------
 
-    WrapInParens([&]() {
-        auto*    funcDecl = dyn_cast_or_null<FunctionDecl>(stmt->getCalleeDecl());
-        unsigned parmIdx{};
+///! Whether a value of \p type can hold on to a coroutine handle or the frame it refers to.
+static bool CanCarryHandle(QualType type)
+{
+    return type->isRecordType() or type->isAnyPointerType() or type->isReferenceType();
+}
+//-----------------------------------------------------------------------------
 
-        ForEachArg(stmt->arguments(), [&](const auto* arg) {
-            ++parmIdx;
+///! Collect the nodes from \p stmt down to \p target in \p path. The parent map of the ASTContext does not know the
+///! nodes the code generators synthesize, hence the chain is built top-down.
+static bool FindParentPath(const Stmt* stmt, const Stmt& target, SmallVectorImpl<DynTypedNode>& path)
+{
+    RETURN_FALSE_IF(nullptr == stmt);
 
-            if(const auto* tmpExpr = dyn_cast_or_null<CXXBindTemporaryExpr>(arg)) {
-                if(const auto* tmp = dyn_cast_or_null<CXXTemporaryObjectExpr>(tmpExpr->getSubExpr())) {
-                    if(GetInsightsOptions().UseShow2C) {
-                        // De-reference the argument since we can only pass temporary objects to functions, not
-                        // pointers
-                        arg = Dref(arg);
+    path.push_back(DynTypedNode::create(*stmt));
 
-                    } else if(GetInsightsOptions().ShowLifetime) {
-                        mOutputFormatHelper.Append(GetName(*tmp));
-                        return;  // from lambda, which is like a continue
-                    }
-                }
-            }
+    if(stmt == &target) {
+        return true;
+    }
 
-            if(GetInsightsOptions().UseShow2C and funcDecl and (funcDecl->getNumParams() >= parmIdx) and
-               IsReferenceType(funcDecl->getParamDecl(parmIdx - 1))) {
-                if(auto* unop = dyn_cast_or_null<UnaryOperator>(arg); not unop or (unop->getOpcode() != UO_AddrOf)) {
-                    arg = Ref(arg);
+    if(const auto* declStmt = dyn_cast_or_null<DeclStmt>(stmt)) {
+        for(const auto* decl : declStmt->decls()) {
+            if(const auto* var = dyn_cast_or_null<VarDecl>(decl)) {
+                path.push_back(DynTypedNode::create(*var));
+
+                if(FindParentPath(var->getInit(), target, path)) {
+                    return true;
                 }
-            }
 
-            InsertArg(arg);
-        });
-    });
+                path.pop_back();
+            }
+        }
 
-    if(insideDecltype) {
-        mLambdaStack.back().setInsertName(false);
+    } else {
+        for(const auto* child : stmt->children()) {
+            if(FindParentPath(child, target, path)) {
+                return true;
+            }
+        }
     }
 
-    mCurrentCallExprPos.reset();
+    path.pop_back();
+
+    return false;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXNamedCastExpr* stmt)
+///! The nodes from the definition of \p function, including the initializers of a constructor, down to \p target.
+static bool FindParentPath(const FunctionDecl& function, const Stmt& target, SmallVectorImpl<DynTypedNode>& path)
 {
-    const QualType castDestType = stmt->getTypeAsWritten();
-    const Expr*    subExpr      = stmt->getSubExpr();
+    if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(&function)) {
+        for(const auto* init : ctor->inits()) {
+            path.push_back(DynTypedNode::create(*init));
 
-    FormatCast(stmt->getCastName(), castDestType, subExpr, stmt->getCastKind());
+            if(FindParentPath(init->getInit(), target, path)) {
+                return true;
+            }
+
+            path.pop_back();
+        }
+    }
+
+    return FindParentPath(function.getBody(), target, path);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ImplicitCastExpr* stmt)
+///! How the object produced by \p expr can outlive the caller. Empty, if it ends with the full-expression or the local
+///! variable it initializes. The result is a predicate for "the result" or the variable.
+static std::string GetHaloEscape(const Expr& expr, bool followVariable)
 {
-    const Expr* subExpr  = stmt->getSubExpr();
-    const auto  castKind = stmt->getCastKind();
-    const bool  hideImplicitCasts{not GetInsightsOptions().ShowAllImplicitCasts};
+    SmallVector<DynTypedNode, 16> path{};
 
-    auto isMatchingCast = [](const CastKind kind, const bool hideImplicitCasts, const bool showXValueCasts) {
-        switch(kind) {
-            case CastKind::CK_Dependent: [[fallthrough]];
-            case CastKind::CK_IntegralCast: [[fallthrough]];
-            case CastKind::CK_IntegralToBoolean: [[fallthrough]];
-            case CastKind::CK_IntegralToPointer: [[fallthrough]];
-            case CastKind::CK_PointerToIntegral: [[fallthrough]];
-            case CastKind::CK_BitCast: [[fallthrough]];
-            case CastKind::CK_UncheckedDerivedToBase: [[fallthrough]];
-            case CastKind::CK_ToUnion:
-                [[fallthrough]];
-                //            case CastKind::CK_UserDefinedConversion: [[fallthrough]];
-            case CastKind::CK_AtomicToNonAtomic: [[fallthrough]];
-            case CastKind::CK_DerivedToBase: [[fallthrough]];
-            case CastKind::CK_FloatingCast: [[fallthrough]];
-            case CastKind::CK_IntegralToFloating: [[fallthrough]];
-            case CastKind::CK_FloatingToIntegral: [[fallthrough]];
-            case CastKind::CK_NonAtomicToAtomic: return true;
-            default:
-                // Special case for structured bindings
-                if((showXValueCasts or not hideImplicitCasts) and (CastKind::CK_NoOp == kind)) {
-                    return true;
-                }
+    if((nullptr == gCurrentFunction) or not FindParentPath(*gCurrentFunction, expr, path)) {
+        return "is used in a way this analysis cannot follow";
+    }
 
-                // Show this casts only if ShowAllImplicitCasts is turned on.
-                if(not hideImplicitCasts) {
-                    switch(kind) {
-                        case CastKind::CK_NullToPointer: [[fallthrough]];
-                        case CastKind::CK_NullToMemberPointer: [[fallthrough]];
-                        /* these are implicit conversions. We get them right, but they may end up in a compiler
-                         * internal type, which leads to compiler errors */
-                        case CastKind::CK_NoOp: [[fallthrough]];
-                        case CastKind::CK_ArrayToPointerDecay: return true;
-                        default: break;
-                    }
-                }
+    // The last node is \p expr itself, walk up from its parent.
+    for(auto idx = path.size() - 1; idx-- > 0;) {
+        const auto& node = path[idx];
 
-                return false;
-        }
-    }(castKind, hideImplicitCasts, stmt->isXValue() or ShowXValueCasts());
+        if(const auto* varDecl = node.get<VarDecl>()) {
+            if(not varDecl->hasLocalStorage()) {
+                return "is stored in a variable with static storage duration";
 
-    if(not isMatchingCast) {
+            } else if(not followVariable) {
+                // A reference to a local is only an alias.
+                return {};
+            }
+
+            SmallVector<const DeclRefExpr*, 8> refs{};
+            if(const auto* function = dyn_cast_or_null<FunctionDecl>(varDecl->getParentFunctionOrMethod())) {
+                FindDeclRefs(function->getBody(), *varDecl, refs);
+            }
+
+            for(const auto* ref : refs) {
+                if(auto escape = GetHaloEscape(*ref, false); not escape.empty()) {
+                    return StrCat(GetName(*varDecl), " "sv, escape);
+                }
+            }
+
+            return {};
+
+        } else if(node.get<CXXCtorInitializer>()) {
+            return "is stored in a member";
+        }
+
+        const auto* stmt = node.get<Stmt>();
+
+        // Look through the nodes which only wrap the object.
+        if(isa_and_nonnull<ImplicitCastExpr, MaterializeTemporaryExpr, CXXBindTemporaryExpr, ExprWithCleanups>(stmt) or
+           isa_and_nonnull<ParenExpr>(stmt)) {
+            continue;
+
+        } else if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(stmt)) {
+            if(not ctorExpr->getConstructor()->isCopyOrMoveConstructor()) {
+                return StrCat("is passed to the constructor of "sv, GetName(ctorExpr->getType()));
+
+            } else if(not followVariable) {
+                return "is copied or moved";
+            }
+
+            continue;
+
+        } else if(const auto* memberExpr = dyn_cast_or_null<MemberExpr>(stmt)) {
+            const auto* memberCall = idx ? path[idx - 1].get<CXXMemberCallExpr>() : nullptr;
+
+            // A field, like the handle itself, can be taken out of the object.
+            if((nullptr == memberCall) or (memberCall->getCallee() != memberExpr)) {
+                return "is accessed through a member";
+            }
+
+            // A member call on the object itself does not let it escape, unless the result can carry the handle, like
+            // an iterator does. Then the result is followed.
+            if(not CanCarryHandle(memberCall->getCallReturnType(GetGlobalAST()))) {
+                return {};
+            }
+
+            --idx;
+            continue;
+
+        } else if(isa_and_nonnull<ReturnStmt, CoreturnStmt>(stmt)) {
+            return "is returned";
+
+        } else if(const auto* callExpr = dyn_cast_or_null<CallExpr>(stmt)) {
+            if(callExpr->isCallToStdMove()) {
+                return "is moved with std::move";
+
+            } else if(const auto* callee = callExpr->getDirectCallee()) {
+                return StrCat("is passed to "sv, GetName(*callee));
+            }
+
+            return "is passed to a function";
+
+        } else if(const auto* binOp = dyn_cast_or_null<BinaryOperator>(stmt); binOp and binOp->isAssignmentOp()) {
+            return "is assigned to another object";
+
+        } else if(stmt and not isa<Expr>(stmt)) {
+            // A discarded value, the temporary dies at the end of the full-expression.
+            return {};
+        }
+
+        break;
+    }
+
+    return "is used in a way this analysis cannot follow";
+}
+//-----------------------------------------------------------------------------
+
+///! Whether the frame allocation of the coroutine called by \p call can be elided (HALO). Clang elides it, if the
+///! coroutine gets inlined and the frame provably does not outlive the caller.
+static std::string GetHaloAnnotation(const CallExpr& call)
+{
+    const auto* callee        = call.getDirectCallee();
+    const auto* definition    = callee ? callee->getDefinition() : nullptr;
+    const auto* coroutineBody = definition ? dyn_cast_or_null<CoroutineBodyStmt>(definition->getBody()) : nullptr;
+
+    if(nullptr == coroutineBody) {
+        return {};
+    }
+
+    std::string ret{" /* HALO: "sv};
+
+    if(const auto escape = GetHaloEscape(call, true); escape.empty()) {
+        ret.append("possible"sv);
+
+    } else if(escape.starts_with("is "sv)) {
+        ret.append(StrCat("not possible, the result "sv, escape));
+
+    } else {
+        ret.append(StrCat("not possible, "sv, escape));
+    }
+
+    SmallVector<std::string_view, 2> promiseFacts{};
+
+    if(const auto* promise = coroutineBody->getPromiseDecl()->getType()->getAsCXXRecordDecl()) {
+        const auto& ctx = promise->getASTContext();
+
+        if(not promise->lookup(ctx.DeclarationNames.getCXXOperatorName(OO_New)).empty()) {
+            promiseFacts.push_back("operator new"sv);
+        }
+    }
+
+    if(coroutineBody->getReturnStmtOnAllocFailure()) {
+        promiseFacts.push_back("get_return_object_on_allocation_failure"sv);
+    }
+
+    for(OnceTrue first{}; const auto& fact : promiseFacts) {
+        ret.append(StrCat(ValueOr(first, "; promise_type has "sv, " and "sv), fact));
+    }
+
+    ret.append(" */"sv);
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXMemberCallExpr* stmt)
+{
+    CONDITIONAL_LAMBDA_SCOPE_HELPER(MemberCallExpr, not InsideDecltype())
+
+    InsertArg(stmt->getCallee());
+
+    WrapInParens([&]() { ForEachArg(stmt->arguments(), [&](const auto& arg) { InsertArg(arg); }); });
+
+    if(GetInsightsOptions().UseShowCoroutineHalo and not InsideDecltype()) {
+        mOutputFormatHelper.Append(GetHaloAnnotation(*stmt));
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ParenExpr* stmt)
+{
+    WrapInParens([&]() { InsertArg(stmt->getSubExpr()); });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXParenListInitExpr* stmt)
+{
+    WrapInParens([&]() { ForEachArg(stmt->getInitExprs(), [&](const auto& init) { InsertArg(init); }); });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const UnaryOperator* stmt)
+{
+    StringRef  opCodeName = UnaryOperator::getOpcodeStr(stmt->getOpcode());
+    const bool insertBefore{not stmt->isPostfix()};
+
+    if(insertBefore) {
+        mOutputFormatHelper.Append(opCodeName);
+    }
+
+    InsertArg(stmt->getSubExpr());
+
+    if(not insertBefore) {
+        mOutputFormatHelper.Append(opCodeName);
+    }
+}
+//-------------	----------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const StringLiteral* stmt)
+{
+    StringStream stream{};
+    stream.Print(*stmt);
+
+    mOutputFormatHelper.Append(stream.str());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ArrayInitIndexExpr* stmt)
+{
+    Error(stmt, "ArrayInitIndexExpr should not be reached in CodeGenerator");
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ArraySubscriptExpr* stmt)
+{
+    if((not GetInsightsOptions().UseAltArraySubscriptionSyntax) or stmt->getLHS()->isLValue()) {
+        InsertArg(stmt->getLHS());
+
+        mOutputFormatHelper.Append('[');
+        InsertArg(stmt->getRHS());
+        mOutputFormatHelper.Append(']');
+    } else {
+
+        mOutputFormatHelper.Append("(*("sv);
+        InsertArg(stmt->getLHS());
+        mOutputFormatHelper.Append(" + "sv);
+
+        InsertArg(stmt->getRHS());
+        mOutputFormatHelper.Append("))"sv);
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ArrayInitLoopExpr* stmt)
+{
+    WrapInCurlys([&]() {
+        const uint64_t size = stmt->getArraySize().getZExtValue();
+
+        ForEachArg(NumberIterator(size), [&](const auto& i) {
+            ArrayInitCodeGenerator codeGenerator{mOutputFormatHelper, i};
+            codeGenerator.InsertArg(stmt->getSubExpr());
+        });
+    });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const OpaqueValueExpr* stmt)
+{
+    InsertArg(stmt->getSourceExpr());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CallExpr* stmt)
+{
+    const bool insideDecltype{InsideDecltype()};
+
+    CONDITIONAL_LAMBDA_SCOPE_HELPER(CallExpr, not insideDecltype)
+    if(insideDecltype) {
+        mLambdaStack.back().setInsertName(true);
+    }
+
+    UpdateCurrentPos(mCurrentCallExprPos);
+
+    InsertArg(stmt->getCallee());
+
+    if(const auto* declRefExpr = dyn_cast_or_null<DeclRefExpr>(stmt->getCallee()->IgnoreImpCasts())) {
+        if(const auto* fd = dyn_cast_or_null<FunctionDecl>(declRefExpr->getDecl())) {
+            if((not declRefExpr->getNumTemplateArgs() and GetInsightsOptions().ShowAllCallExprTemplateParameters) or
+               isa<UserDefinedLiteral>(stmt)) {
+                InsertTemplateArgs(*fd);
+            }
+        }
+    }
+
+    WrapInParens([&]() {
+        auto*    funcDecl = dyn_cast_or_null<FunctionDecl>(stmt->getCalleeDecl());
+        unsigned parmIdx{};
+
+        ForEachArg(stmt->arguments(), [&](const auto* arg) {
+            ++parmIdx;
+
+            if(const auto* tmpExpr = dyn_cast_or_null<CXXBindTemporaryExpr>(arg)) {
+                if(const auto* tmp = dyn_cast_or_null<CXXTemporaryObjectExpr>(tmpExpr->getSubExpr())) {
+                    if(GetInsightsOptions().UseShow2C) {
+                        // De-reference the argument since we can only pass temporary objects to functions, not
+                        // pointers
+                        arg = Dref(arg);
+
+                    } else if(GetInsightsOptions().ShowLifetime) {
+                        mOutputFormatHelper.Append(GetName(*tmp));
+                        return;  // from lambda, which is like a continue
+                    }
+                }
+            }
+
+            if(GetInsightsOptions().UseShow2C and funcDecl and (funcDecl->getNumParams() >= parmIdx) and
+               IsReferenceType(funcDecl->getParamDecl(parmIdx - 1))) {
+                if(auto* unop = dyn_cast_or_null<UnaryOperator>(arg); not unop or (unop->getOpcode() != UO_AddrOf)) {
+                    arg = Ref(arg);
+                }
+            }
+
+            InsertArg(arg);
+        });
+    });
+
+    if(insideDecltype) {
+        mLambdaStack.back().setInsertName(false);
+
+    } else if(GetInsightsOptions().UseShowCoroutineHalo) {
+        mOutputFormatHelper.Append(GetHaloAnnotation(*stmt));
+    }
+
+    mCurrentCallExprPos.reset();
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXNamedCastExpr* stmt)
+{
+    const QualType castDestType = stmt->getTypeAsWritten();
+    const Expr*    subExpr      = stmt->getSubExpr();
+
+    FormatCast(stmt->getCastName(), castDestType, subExpr, stmt->getCastKind());
+}
+//-----------------------------------------------------------------------------
+
+///! The runtime cost of the implicit conversion \p stmt as a comment for \c --show-costly-conversions. Empty, if the
+///! conversion is free or happens at compile-time.
+static std::string GetConversionCost(const ImplicitCastExpr& stmt)
+{
+    const auto* subExpr = stmt.getSubExpr();
+    const auto& ctx     = GetGlobalAST();
+
+    // Written by the user or resolved by the compiler, nothing hidden here.
+    if(stmt.isPartOfExplicitCast() or stmt.isTypeDependent() or subExpr->isValueDependent()) {
+        return {};
+    }
+
+    const auto toType   = stmt.getType();
+    const auto fromType = subExpr->getType();
+
+    const std::string cost = [&]() -> std::string {
+        switch(stmt.getCastKind()) {
+            case CastKind::CK_UserDefinedConversion:
+                if(const auto* call = dyn_cast_or_null<CXXMemberCallExpr>(subExpr->IgnoreParens())) {
+                    return StrCat("calls "sv, call->getMethodDecl()->getQualifiedNameAsString());
+                }
+
+                return "user-defined conversion";
+
+            case CastKind::CK_ConstructorConversion: {
+                const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(subExpr->IgnoreParens());
+
+                if((nullptr == ctorExpr) or (0 == ctorExpr->getConstructor()->getNumParams())) {
+                    return {};
+                }
+
+                std::string ret{StrCat("converting constructor of "sv,
+                                       GetName(toType.getUnqualifiedType()),
+                                       " from "sv,
+                                       GetName(ctorExpr->getConstructor()->getParamDecl(0)->getType()))};
+
+                // Allocator-aware types like std::string or std::vector announce themselves by an allocator_type.
+                if(const auto* record = toType->getAsCXXRecordDecl();
+                   record and not record->lookup(&ctx.Idents.get("allocator_type"sv)).empty()) {
+                    ret.append(", may allocate"sv);
+                }
+
+                return ret;
+            }
+
+            case CastKind::CK_DerivedToBase: [[fallthrough]];
+            case CastKind::CK_UncheckedDerivedToBase:
+                for(const auto* base : stmt.path()) {
+                    if(base->isVirtual()) {
+                        return StrCat("derived-to-base through virtual base "sv,
+                                      GetName(base->getType()),
+                                      ", reads the offset from the vtable"sv);
+                    }
+                }
+
+                return {};
+
+            default: break;
+        }
+
+        // The remaining conversions of constants are folded by the compiler.
+        if(subExpr->isEvaluatable(ctx)) {
+            return {};
+        }
+
+        switch(stmt.getCastKind()) {
+            case CastKind::CK_IntegralToFloating: return "integer to floating-point";
+            case CastKind::CK_FloatingToIntegral: return "floating-point to integer, truncates";
+
+            case CastKind::CK_FloatingCast:
+                if(ctx.getTypeSize(toType) < ctx.getTypeSize(fromType)) {
+                    return "narrowing floating-point conversion, loses precision";
+                }
+
+                return "floating-point widening";
+
+            case CastKind::CK_IntegralCast:
+                if(ctx.getTypeSize(toType) < ctx.getTypeSize(fromType)) {
+                    return StrCat("narrowing, truncates to "sv, ctx.getTypeSize(toType), " bits"sv);
+                }
+
+                // Sign changes and extensions come for free with the load.
+                return {};
+
+            default: return {};
+        }
+    }();
+
+    if(cost.empty()) {
+        return {};
+    }
+
+    return StrCat(" /* cost: "sv, cost, " */"sv);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ImplicitCastExpr* stmt)
+{
+    const Expr* subExpr  = stmt->getSubExpr();
+    const auto  castKind = stmt->getCastKind();
+    const bool  hideImplicitCasts{not GetInsightsOptions().ShowAllImplicitCasts};
+
+    auto isMatchingCast = [](const CastKind kind, const bool hideImplicitCasts, const bool showXValueCasts) {
+        switch(kind) {
+            case CastKind::CK_Dependent: [[fallthrough]];
+            case CastKind::CK_IntegralCast: [[fallthrough]];
+            case CastKind::CK_IntegralToBoolean: [[fallthrough]];
+            case CastKind::CK_IntegralToPointer: [[fallthrough]];
+            case CastKind::CK_PointerToIntegral: [[fallthrough]];
+            case CastKind::CK_BitCast: [[fallthrough]];
+            case CastKind::CK_UncheckedDerivedToBase: [[fallthrough]];
+            case CastKind::CK_ToUnion:
+                [[fallthrough]];
+                //            case CastKind::CK_UserDefinedConversion: [[fallthrough]];
+            case CastKind::CK_AtomicToNonAtomic: [[fallthrough]];
+            case CastKind::CK_DerivedToBase: [[fallthrough]];
+            case CastKind::CK_FloatingCast: [[fallthrough]];
+            case CastKind::CK_IntegralToFloating: [[fallthrough]];
+            case CastKind::CK_FloatingToIntegral: [[fallthrough]];
+            case CastKind::CK_NonAtomicToAtomic: return true;
+            default:
+                // Special case for structured bindings
+                if((showXValueCasts or not hideImplicitCasts) and (CastKind::CK_NoOp == kind)) {
+                    return true;
+                }
+
+                // Show this casts only if ShowAllImplicitCasts is turned on.
+                if(not hideImplicitCasts) {
+                    switch(kind) {
+                        case CastKind::CK_NullToPointer: [[fallthrough]];
+                        case CastKind::CK_NullToMemberPointer: [[fallthrough]];
+                        /* these are implicit conversions. We get them right, but they may end up in a compiler
+                         * internal type, which leads to compiler errors */
+                        case CastKind::CK_NoOp: [[fallthrough]];
+                        case CastKind::CK_ArrayToPointerDecay: return true;
+                        default: break;
+                    }
+                }
+
+                return false;
+        }
+    }(castKind, hideImplicitCasts, stmt->isXValue() or ShowXValueCasts());
+
+    const bool        showCostlyConversions{GetInsightsOptions().ShowCostlyConversions};
+    const std::string conversionCost{showCostlyConversions ? GetConversionCost(*stmt) : std::string{}};
+
+    // The user-defined conversions are already visible as call or construction, they are printed as usual and only
+    // get the tag.
+    const bool isUserDefined{
+        is{castKind}.any_of(CastKind::CK_UserDefinedConversion, CastKind::CK_ConstructorConversion)};
+
+    // With --show-costly-conversions only the conversions with a runtime cost are shown. The xvalue casts of
+    // structured bindings stay, the result does not compile without them.
+    const bool showCast{
+        (showCostlyConversions and not isUserDefined)
+            ? (not conversionCost.empty() or
+               ((CastKind::CK_NoOp == castKind) and (stmt->isXValue() or ShowXValueCasts())))
+            : isMatchingCast};
+
+    if(not showCast) {
         if(GetInsightsOptions().UseShow2C and (castKind == CastKind::CK_LValueToRValue) and
            IsReferenceType(dyn_cast_or_null<DeclRefExpr>(subExpr))) {
             mOutputFormatHelper.Append("*"sv);
         }
 
-        InsertArg(subExpr);
+        InsertArg(subExpr);
+        mOutputFormatHelper.Append(conversionCost);
+
+    } else if(isa<IntegerLiteral>(subExpr) and hideImplicitCasts) {
+        InsertArg(stmt->IgnoreCasts());
+
+        // If this is part of an explicit cast, for example a CStyleCast or static_cast, ignore it, because it
+        // belongs to the cast written by the user.
+    } else if(stmt->isPartOfExplicitCast()) {
+        // For a CStyleCast we get an AST like this:
+        //
+        // CStyleCastExpr 0x13205cdc0 'uint32_t':'unsigned int' <NoOp>
+        // `-ImplicitCastExpr 0x13205cda8 'uint32_t':'unsigned int' <IntegralCast> part_of_explicit_cast
+        //  `-CStyleCastExpr 0x13205cd70 'uint16_t':'unsigned short' <NoOp>
+        //
+        // Without filtering the `uint32_t` cast appears twice. The code below takes that into account and skips the
+        // `ImplicitCastExpr` if the sub-expression is a `CStyleCastExpr`.
+        if(isa<CStyleCastExpr>(subExpr) or isa<CXXNamedCastExpr>(subExpr)) {
+            InsertArg(subExpr);
+        } else {
+            InsertArg(stmt->IgnoreCasts());
+        }
+
+    } else {
+        auto           castName{GetCastName(castKind)};
+        const QualType castDestType{[&] {
+            auto type{stmt->getType()};
+
+            // In case of a dependent type the canonical type doesn't know the parameters name.
+            if(not type->isDependentType()) {
+                type = type.getCanonicalType();
+            }
+
+            // In at least the case a structured bindings the compiler adds xvalue casts but the && is missing to
+            // make it valid C++.
+            if(VK_XValue == stmt->getValueKind()) {
+                return GetGlobalAST().getRValueReferenceType(type);
+            }
+
+            return type;
+        }()};
+
+        FormatCast(castName, castDestType, subExpr, castKind);
+        mOutputFormatHelper.Append(conversionCost);
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const DeclRefExpr* stmt)
+{
+    if(const auto* tmplObjParam = dyn_cast_or_null<TemplateParamObjectDecl>(stmt->getDecl())) {
+        mOutputFormatHelper.Append(GetName(*tmplObjParam));
+
+    } else if(const auto* vd = dyn_cast_or_null<VarDecl>(stmt->getDecl());
+              GetInsightsOptions().UseShow2C and IsReferenceType(vd)) {
+        const auto* init = vd->getInit();
+
+        if(const auto* dref = dyn_cast_or_null<DeclRefExpr>(init)) {
+            mOutputFormatHelper.Append(GetName(*dref));
+            return;
+
+        } else if(const auto* inList = dyn_cast_or_null<InitListExpr>(init)) {
+            mOutputFormatHelper.Append(GetName(*dyn_cast_or_null<DeclRefExpr>(inList->getInit(0))));
+            return;
+        }
+    }
+
+    if(const auto* ctx = stmt->getDecl()->getDeclContext(); not ctx->isFunctionOrMethod() and
+                                                            not isa<NonTypeTemplateParmDecl>(stmt->getDecl()) and
+                                                            not GetInsightsOptions().UseShow2C) {
+        if(const auto* qualifier = stmt->getQualifier();
+           qualifier and (qualifier->getKind() == NestedNameSpecifier::SpecifierKind::Global)) {
+            // According to
+            // https://clang.llvm.org/doxygen/classclang_1_1NestedNameSpecifier.html#ac707a113605ed4283684b8c05664eb6f
+            // the global specifier is not stored.
+            mOutputFormatHelper.Append("::"sv, GetPlainName(*stmt));
+
+        } else {
+            OutputFormatHelper   ofm{};
+            CodeGeneratorVariant codeGenerator{ofm};
+
+            codeGenerator->ParseDeclContext(ctx);
+
+            mOutputFormatHelper.Append(ScopeHandler::RemoveCurrentScope(ofm.GetString()), GetPlainName(*stmt));
+        }
+
+    } else {
+        mOutputFormatHelper.Append(GetName(*stmt));
+    }
+
+    if(const auto* varTmplSpecDecl = dyn_cast_or_null<VarTemplateSpecializationDecl>(stmt->getDecl())) {
+        InsertTemplateArgs(*varTmplSpecDecl);
+    } else {
+        InsertTemplateArgs(*stmt);
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CompoundStmt* stmt)
+{
+    mOutputFormatHelper.OpenScope();
+    mLifeTimeTracker.StartScope(isa_and_nonnull<FunctionDecl>(mLastDecl));
+
+    // prevent nested CompoundStmt's to insert a return on each leave. Only insert it before closing the most outer
+    // one.
+    const bool requiresImplicitReturnZero{std::exchange(mRequiresImplicitReturnZero, false)};
+
+    HandleCompoundStmt(stmt);
+
+    if(requiresImplicitReturnZero) {
+        InsertArg(Return(Int32(0)));
+
+        if(not mSkipSemi) {
+            InsertArg(mkNullStmt());
+        }
+    }
+
+    mSkipSemi = mLifeTimeTracker.EndScope(mOutputFormatHelper, isa_and_nonnull<ReturnStmt>(mLastStmt));
+
+    mOutputFormatHelper.CloseScope(OutputFormatHelper::NoNewLineBefore::Yes);
+}
+//-----------------------------------------------------------------------------
+
+template<typename... Args>
+static bool IsStmtRequiringSemi(const Stmt* stmt)
+{
+    return (... and not isa<Args>(stmt));
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::HandleCompoundStmt(const CompoundStmt* stmt)
+{
+    for(const auto* item : stmt->body()) {
+        InsertArg(item);
+
+        // Skip inserting a semicolon, if this is a LambdaExpr and out stack is empty. This addresses a special case
+        // #344.
+        const bool skipSemiForLambda{mLambdaStack.empty() and isa<LambdaExpr>(item)};
+
+        if(IsStmtRequiringSemi<IfStmt,
+                               NullStmt,
+                               ForStmt,
+                               DeclStmt,
+                               WhileStmt,
+                               DoStmt,
+                               CXXForRangeStmt,
+                               SwitchStmt,
+                               CXXTryStmt,
+                               CppInsightsCommentStmt>(item) and
+           InsertSemi() and not skipSemiForLambda and not mSkipSemi) {
+            mOutputFormatHelper.AppendSemiNewLine();
+        }
+
+        mSkipSemi = false;
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertIfOrSwitchInitVariables(same_as_any_of<const IfStmt, const SwitchStmt> auto* stmt)
+{
+    if(const auto* conditionVar = stmt->getConditionVariable()) {
+        InsertArg(conditionVar);
+    }
+
+    if(const auto* init = stmt->getInit()) {
+        InsertArg(init);
+
+        if(not isa<DeclStmt>(init)) {
+            mOutputFormatHelper.AppendSemiNewLine();
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const IfStmt* stmt)
+{
+    const bool hasInit{stmt->getInit() or stmt->getConditionVariable()};
+
+    if(hasInit) {
+        mOutputFormatHelper.OpenScope();
+
+        InsertIfOrSwitchInitVariables(stmt);
+    }
+
+    mOutputFormatHelper.Append("if"sv, ValueOrDefault(stmt->isConstexpr(), kwSpaceConstExpr));
+
+    WrapInParensIfNeeded(
+        not stmt->isConsteval(),
+        [&]() {
+            mShowConstantExprValue = ShowConstantExprValue::Yes;
+
+            InsertArg(stmt->getCond());
+
+            mShowConstantExprValue = ShowConstantExprValue::No;
+        },
+        AddSpaceAtTheEnd::Yes);
+
+    mOutputFormatHelper.Append(ValueOrDefault(stmt->isNegatedConsteval(), " !"sv),
+                               ValueOrDefault(stmt->isConsteval(), kwSpaceConstEvalSpace));
+
+    if(GetInsightsOptions().UseShowConstevalSplit and not stmt->isConsteval()) {
+        if(const auto split = GetConstevalSplit(*stmt->getCond()); not split.empty()) {
+            mOutputFormatHelper.AppendComment(split);
+            mOutputFormatHelper.Append(" "sv);
+        }
+    }
+
+    WrapInCompoundIfNeeded(stmt->getThen(), AddNewLineAfter::No);
+
+    // else
+    if(const auto* elsePart = stmt->getElse()) {
+        mOutputFormatHelper.Append(
+            "else "sv,
+            ValueOrDefault(stmt->isConstexpr(), StrCat(kwCCommentStartSpace, kwConstExprSpace, kwCCommentEndSpace)));
+
+        WrapInCompoundIfNeeded(elsePart, AddNewLineAfter::No);
+    }
+
+    // Add newline after last closing curly (either from if or else if).
+    mOutputFormatHelper.AppendNewLine();
+
+    if(hasInit) {
+        mOutputFormatHelper.CloseScope();
+        mOutputFormatHelper.AppendNewLine();
+    }
+
+    // one blank line after statement
+    mOutputFormatHelper.AppendNewLine();
+}
+//-----------------------------------------------------------------------------
+
+class ContinueASTTransformer : public StmtVisitor<ContinueASTTransformer>
+{
+    Stmt*            mPrevStmt{};
+    std::string_view mContinueLabel{};
+
+public:
+    bool found{};
+
+    ContinueASTTransformer(Stmt* stmt, std::string_view continueLabel)
+    : mPrevStmt{stmt}
+    , mContinueLabel{continueLabel}
+    {
+        Visit(stmt);
+    }
+
+    void Visit(Stmt* stmt)
+    {
+        if(stmt) {
+            StmtVisitor<ContinueASTTransformer>::Visit(stmt);
+        }
+    }
+
+    void VisitContinueStmt(ContinueStmt* stmt)
+    {
+        found = true;
+
+        ReplaceNode(mPrevStmt, stmt, Goto(mContinueLabel));
+    }
+
+    void VisitStmt(Stmt* stmt)
+    {
+        auto* tmp = mPrevStmt;
+        mPrevStmt = stmt;
+
+        for(auto* child : stmt->children()) {
+            Visit(child);
+        }
+
+        mPrevStmt = tmp;
+    }
+};
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ForStmt* stmt)
+{
+    PushLoop(stmt);
+
+    // https://github.com/vtjnash/clang-ast-builder/blob/master/AstBuilder.cpp
+    // http://clang-developers.42468.n3.nabble.com/Adding-nodes-to-Clang-s-AST-td4054800.html
+    // https://stackoverflow.com/questions/30451485/how-to-clone-or-create-an-ast-stmt-node-of-clang/38899615
+
+    if(GetInsightsOptions().UseAltForSyntax) {
+        auto*          rwStmt = const_cast<ForStmt*>(stmt);
+        const auto&    ctx    = GetGlobalAST();
+        StmtsContainer bodyStmts{};
+
+        auto       continueLabel = MakeLineColumnName(ctx.getSourceManager(), stmt->getBeginLoc(), "__continue_"sv);
+        const bool insertLabel   = ContinueASTTransformer{rwStmt->getBody(), continueLabel}.found;
+
+        bodyStmts.AddBodyStmts(rwStmt->getBody());
+
+        // Build and insert the continue goto label
+        if(insertLabel) {
+            bodyStmts.Add(Label(continueLabel));
+        }
+
+        bodyStmts.Add(rwStmt->getInc());
+
+        auto* condition = [&]() -> Expr* {
+            if(rwStmt->getCond()) {
+                return rwStmt->getCond();
+            }
+
+            return Bool(true);
+        }();
+
+        auto* outerBody = mkCompoundStmt(bodyStmts, stmt->getBeginLoc(), stmt->getEndLoc());
+        auto* whileStmt = WhileStmt::Create(
+            ctx, nullptr, condition, outerBody, stmt->getBeginLoc(), stmt->getLParenLoc(), stmt->getRParenLoc());
+
+        StmtsContainer outerScopeStmts{};
+        outerScopeStmts.Add(rwStmt->getInit());
+        outerScopeStmts.Add(whileStmt);
+
+        auto* outerScopeBody = mkCompoundStmt(outerScopeStmts, stmt->getBeginLoc(), stmt->getEndLoc());
+
+        InsertArg(outerScopeBody);
+        mOutputFormatHelper.AppendNewLine();
+
+    } else {
+        {
+            // We need to handle the case that a lambda is used in the init-statement of the for-loop.
+            LAMBDA_SCOPE_HELPER(VarDecl);
+
+            mOutputFormatHelper.Append("for"sv);
+
+            WrapInParens(
+                [&]() {
+                    if(const auto* init = stmt->getInit()) {
+                        MultiStmtDeclCodeGenerator codeGenerator{
+                            mOutputFormatHelper, mLambdaStack, InsertVarDecl(nullptr)};
+                        codeGenerator.InsertArg(init);
+
+                    } else {
+                        mOutputFormatHelper.Append("; "sv);
+                    }
+
+                    InsertArg(stmt->getCond());
+                    mOutputFormatHelper.Append("; "sv);
+
+                    InsertArg(stmt->getInc());
+                },
+                AddSpaceAtTheEnd::Yes);
+        }
+
+        WrapInCompoundIfNeeded(stmt->getBody(), AddNewLineAfter::Yes);
+    }
+
+    mOutputFormatHelper.AppendNewLine();
+}
+//-----------------------------------------------------------------------------
+
+static bool IsConstQualifiedType(QualType type)
+{
+    if(not type.isNull()) {
+        if(auto* typePtr = type.getTypePtrOrNull()) {
+            if(auto pointee = typePtr->getPointeeType(); not pointee.isNull()) {
+                return pointee.isConstQualified();
+            }
+        }
+    }
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CStyleCastExpr* stmt)
+{
+    const auto     castKind     = stmt->getCastKind();
+    const QualType castDestType = stmt->getType().getCanonicalType();
+    const auto     castName     = GetCastName(
+        castKind, IsConstQualifiedType(castDestType) != IsConstQualifiedType(stmt->getSubExpr()->getType()));
+
+    FormatCast(castName, castDestType, stmt->getSubExpr(), castKind);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXNewExpr* stmt)
+{
+    const auto  noEmptyInitList = mNoEmptyInitList;
+    FinalAction _{[&] { mNoEmptyInitList = noEmptyInitList; }};
+    mNoEmptyInitList = GetInsightsOptions().UseShow2C ? NoEmptyInitList::Yes : NoEmptyInitList::No;
+
+    mOutputFormatHelper.Append("new "sv);
+
+    if(stmt->getNumPlacementArgs()) {
+        /* we have a placement new */
+
+        WrapInParens([&]() {
+            ForEachArg(stmt->placement_arguments(), [&](const auto& placementArg) { InsertArg(placementArg); });
+        });
+    }
+
+    if(const auto* ctorExpr = stmt->getConstructExpr()) {
+        InsertArg(ctorExpr);
+
+    } else {
+        auto name = GetName(stmt->getAllocatedType());
+
+        // Special handling for arrays. They differ from one to more dimensions.
+        if(stmt->isArray()) {
+            OutputFormatHelper   ofm{};
+            CodeGeneratorVariant codeGenerator{ofm};
+
+            ofm.Append('[');
+            codeGenerator->InsertArg(stmt->getArraySize().value());
+            ofm.Append(']');
+
+            // In case of multi dimension the first dimension is the getArraySize() while the others are part of the
+            // type included in GetName(...).
+            if(Contains(name, "["sv)) {
+                InsertBefore(name, "["sv, ofm.GetString());
+            } else {
+                // here we have the single dimension case, the dimension is not part of GetName, so add it.
+                name.append(ofm);
+            }
+        }
+
+        mOutputFormatHelper.Append(name);
+
+        if(stmt->hasInitializer()) {
+            InsertCurlysIfRequired(stmt->getInitializer());
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const MaterializeTemporaryExpr* stmt)
+{
+    // At least in case of a ternary operator wrapped inside a MaterializeTemporaryExpr parens are necessary
+    const auto* temporary = stmt->getSubExpr();
+    WrapInParensIfNeeded(isa_and_nonnull<ConditionalOperator>(temporary), [&] { InsertArg(temporary); });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXOperatorCallExpr* stmt)
+{
+    LAMBDA_SCOPE_HELPER(OperatorCallExpr);
+
+    FinalAction _{[&] {
+        if(GetInsightsOptions().UseShowCopies) {
+            InsertCopyAnnotation(*stmt);
+        }
+    }};
+
+    const auto* callee = dyn_cast_or_null<DeclRefExpr>(stmt->getCallee()->IgnoreImpCasts());
+    const bool  isCXXMethod{callee and isa<CXXMethodDecl>(callee->getDecl())};
+
+    if(2 == stmt->getNumArgs()) {
+        auto getArg = [&](unsigned idx) {
+            const auto* arg = stmt->getArg(idx);
+
+            // In show all casts mode don't filter this. It shows how the compiler adds const to arguments, if the
+            // argument is non-const but the parameter demands a const object
+            if(not GetInsightsOptions().ShowAllImplicitCasts) {
+                arg = arg->IgnoreImpCasts();
+            }
+
+            return dyn_cast_or_null<DeclRefExpr>(arg);
+        };
+
+        const auto* param1 = getArg(0);
+        const auto* param2 = getArg(1);
+
+        if(callee and param1 and param2) {
+            const std::string replace = [&]() {
+                // If the argument is a variable template, add the template arguments to the parameter name.
+                auto nameWithTmplArguments = [](const auto param) {
+                    return FormatVarTemplateSpecializationDecl(param->getDecl(), GetName(*param));
+                };
+
+                if(isa<CXXMethodDecl>(callee->getDecl())) {
+                    return StrCat(nameWithTmplArguments(param1),
+                                  "."sv,
+                                  GetName(*callee),
+                                  "("sv,
+                                  nameWithTmplArguments(param2),
+                                  ")"sv);
+                } else {
+                    return StrCat(GetName(*callee),
+                                  "("sv,
+                                  nameWithTmplArguments(param1),
+                                  ", "sv,
+                                  nameWithTmplArguments(param2),
+                                  ")"sv);
+                }
+            }();
+
+            mOutputFormatHelper.Append(replace);
+
+            return;
+        }
+    }
+
+    auto        cb           = stmt->child_begin();
+    const auto* fallbackArg0 = stmt->getArg(0);
+
+    // arg0 := operator
+    // skip arg0
+    std::advance(cb, 1);
+
+    const auto* arg1 = *cb;
+
+    std::advance(cb, 1);
+
+    // operators in a namespace but outside a class so operator goes first
+    if(not isCXXMethod) {
+        // happens for UnresolvedLooupExpr
+        if(not callee) {
+            if(const auto* adl = dyn_cast_or_null<UnresolvedLookupExpr>(stmt->getCallee())) {
+                InsertArg(adl);
+            }
+        } else {
+            mOutputFormatHelper.Append(GetName(*callee));
+        }
+
+        mOutputFormatHelper.Append("("sv);
+    }
+
+    // insert the arguments
+    if(isa<DeclRefExpr>(fallbackArg0)) {
+        InsertArgWithParensIfNeeded(fallbackArg0);
+
+    } else {
+        InsertArgWithParensIfNeeded(arg1);
+    }
+
+    // if it is a class operator the operator follows now
+    if(isCXXMethod) {
+        const OverloadedOperatorKind opKind = stmt->getOperator();
+
+        const std::string_view operatorKw{ValueOr((OO_Coawait == opKind), kwOperatorSpace, kwOperator)};
+
+        mOutputFormatHelper.Append("."sv, operatorKw, getOperatorSpelling(opKind), "("sv);
+    }
+
+    // consume all remaining arguments
+    const auto childRange = llvm::make_range(cb, stmt->child_end());
+
+    // at least the call-operator can have more than 2 parameters
+    ForEachArg(childRange, [&](const auto& child) {
+        if(not isCXXMethod) {
+            // in global operators we need to separate the two parameters by comma
+            mOutputFormatHelper.Append(", "sv);
+        }
+
+        InsertArg(child);
+    });
+
+    mOutputFormatHelper.Append(')');
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const LambdaExpr* stmt)
+{
+    if(not mLambdaStack.empty()) {
+        const bool insertName{mLambdaStack.back().insertName()};
+
+        HandleLambdaExpr(stmt, mLambdaStack.back());
+
+        if(insertName) {
+            mOutputFormatHelper.Append(GetLambdaName(*stmt));
+        }
+
+    } else if(LambdaInInitCapture::Yes == mLambdaInitCapture) {
+        LAMBDA_SCOPE_HELPER(InitCapture);
+        HandleLambdaExpr(stmt, mLambdaStack.back());
+    } else {
+        LAMBDA_SCOPE_HELPER(LambdaExpr);
+        HandleLambdaExpr(stmt, mLambdaStack.back());
+    }
+
+    if(not mLambdaStack.empty()) {
+        mLambdaStack.back().insertInits(mOutputFormatHelper);
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXThisExpr*)
+{
+    mOutputFormatHelper.Append(kwThis);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXBindTemporaryExpr* stmt)
+{
+    InsertArg(stmt->getSubExpr());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXFunctionalCastExpr* stmt)
+{
+    const bool isConstructor{isa<CXXConstructExpr>(stmt->getSubExpr())};
+    const bool isStdListInit{isa<CXXStdInitializerListExpr>(stmt->getSubExpr())};
+    const bool isListInitialization{stmt->getLParenLoc().isInvalid()};
+    const bool needsParens{not isConstructor and not isListInitialization and not isStdListInit};
+
+    // If a constructor follows we do not need to insert the type name. This would insert it twice.
+    if(not isConstructor and not isStdListInit) {
+        mOutputFormatHelper.Append(GetName(stmt->getTypeAsWritten()));
+    }
+
+    WrapInParensIfNeeded(needsParens, [&] { InsertArg(stmt->getSubExpr()); });
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXBoolLiteralExpr* stmt)
+{
+    mOutputFormatHelper.Append(details::ConvertToBoolString(stmt->getValue()));
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const GNUNullExpr* /*stmt*/)
+{
+    mOutputFormatHelper.Append(kwNull);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CharacterLiteral* stmt)
+{
+    StringStream stream{};
+    stream.Print(*stmt);
+
+    auto str = std::move(stream.str());
+
+    if(str == "'\\x00'"sv) {
+        str = "'\\0'"sv;
+    } else if(str == "'\\xff'"sv) {
+        str = "255"sv;
+    }
+
+    mOutputFormatHelper.Append(str);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const PredefinedExpr* stmt)
+{
+    // Check if getFunctionName returns a valid StringLiteral. It does return a nullptr, if this PredefinedExpr is
+    // in a UnresolvedLookupExpr. In that case, print the identifier, e.g. __func__.
+    if(const auto* functionName = stmt->getFunctionName()) {
+        InsertArg(functionName);
+    } else {
+        const auto name = PredefinedExpr::getIdentKindName(stmt->getIdentKind());
+
+        mOutputFormatHelper.Append(name);
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ExprWithCleanups* stmt)
+{
+    mLifeTimeTracker.StartScope(false);
+    TemporaryDeclFinder temporaryFinder{*this, not mProcessingVarDecl ? stmt->getSubExpr() : nullptr};
+
+    InsertArg(stmt->getSubExpr());
+
+    if(GetInsightsOptions().ShowLifetime and not mProcessingVarDecl) {
+        mOutputFormatHelper.AppendSemiNewLine();
+    }
+
+    mSkipSemi = mLifeTimeTracker.EndScope(mOutputFormatHelper, false);
+}
+//-----------------------------------------------------------------------------
+
+std::string CodeGenerator::GetValueOfValueInit(const QualType& t)
+{
+    const QualType& type = t.getCanonicalType();
+
+    if(type->isScalarType()) {
+        switch(type->getScalarTypeKind()) {
+            case Type::STK_CPointer:
+            case Type::STK_BlockPointer:
+            case Type::STK_ObjCObjectPointer:
+            case Type::STK_MemberPointer: return std::string{kwNullptr};
+
+            case Type::STK_Bool: return std::string{kwFalse};
+
+            case Type::STK_Integral:
+            case Type::STK_Floating:
+                if(const auto* bt = type->getAs<BuiltinType>()) {
+                    switch(bt->getKind()) {
+                            // Type::STK_Integral
+                        case BuiltinType::Char_U:
+                        case BuiltinType::UChar:
+                        case BuiltinType::Char_S:
+                        case BuiltinType::SChar: return "'\\0'";
+                        case BuiltinType::WChar_U:
+                        case BuiltinType::WChar_S: return "L'\\0'";
+                        case BuiltinType::Char16: return "u'\\0'";
+                        case BuiltinType::Char32: return "U'\\0'";
+                        // Type::STK_Floating
+                        case BuiltinType::Half:
+                        case BuiltinType::Float: return "0.0f";
+                        case BuiltinType::Double: return "0.0";
+                        default: break;
+                    }
+                }
+
+                break;
+
+            case Type::STK_FloatingComplex:
+            case Type::STK_IntegralComplex:
+                if(const auto* complexType = type->getAs<ComplexType>()) {
+                    return GetValueOfValueInit(complexType->getElementType());
+                }
+
+                break;
+
+            case Type::STK_FixedPoint: Error("STK_FixedPoint is not implemented"); break;
+        }
+
+    } else if(const auto* tt = dyn_cast_or_null<ConstantArrayType>(t.getTypePtrOrNull())) {
+        const auto&       elementType{tt->getElementType()};
+        const std::string elementTypeInitValue{GetValueOfValueInit(elementType)};
+
+        return FillConstantArray(tt, elementTypeInitValue, uint64_t{0});
+    }
+
+    return std::string{"0"sv};
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ImplicitValueInitExpr* stmt)
+{
+    mOutputFormatHelper.Append(GetValueOfValueInit(stmt->getType()));
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXScalarValueInitExpr* stmt)
+{
+    mOutputFormatHelper.Append(GetName(stmt->getType()), "()"sv);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXTryStmt* stmt)
+{
+    mOutputFormatHelper.AppendNewLine(kwTrySpace);
+
+    InsertArg(stmt->getTryBlock());
+
+    for(const auto& i : NumberIterator{stmt->getNumHandlers()}) {
+        InsertArg(stmt->getHandler(i));
+    }
+
+    mOutputFormatHelper.AppendNewLine();
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXCatchStmt* stmt)
+{
+    mOutputFormatHelper.Append(" catch"sv);
+
+    WrapInParens(
+        [&]() {
+            if(not stmt->getCaughtType().isNull()) {
+                mOutputFormatHelper.Append(
+                    GetTypeNameAsParameter(stmt->getCaughtType(), stmt->getExceptionDecl()->getName()));
+            } else {
+                mOutputFormatHelper.Append(kwElipsis);
+            }
+        },
+        AddSpaceAtTheEnd::Yes);
+
+    InsertArg(stmt->getHandlerBlock());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXThrowExpr* stmt)
+{
+    mOutputFormatHelper.Append("throw "sv);
+
+    InsertArg(stmt->getSubExpr());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const ConstantExpr* stmt)
+{
+    if((ShowConstantExprValue::Yes == mShowConstantExprValue) and stmt->hasAPValueResult()) {
+        if(const auto value = stmt->getAPValueResult(); value.isInt()) {
+            mOutputFormatHelper.Append(value.getInt());
+            return;
+        }
+    }
+
+    InsertArg(stmt->getSubExpr());
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const TypeAliasDecl* stmt)
+{
+    const auto& underlyingType = stmt->getUnderlyingType();
+
+    LAMBDA_SCOPE_HELPER(Decltype);
+    P0315Visitor dt{*this};
+    dt.TraverseTypeIfLambda(underlyingType);
+
+    mOutputFormatHelper.Append(kwUsingSpace, GetName(*stmt), hlpAssing);
+
+    if(auto* templateSpecializationType = underlyingType->getAs<TemplateSpecializationType>()) {
+        const bool carriesNamespace{[&] {
+            if(const auto tn = templateSpecializationType->getTemplateName();
+               (TemplateName::QualifiedTemplate == tn.getKind()) or (TemplateName::DependentTemplate == tn.getKind())) {
+                const auto* qtn = tn.getAsQualifiedTemplateName();
+
+                return qtn->getQualifier() != nullptr;
+            }
+
+            return false;
+        }()};
+
+        if(const auto* elaboratedType = underlyingType->getAs<ElaboratedType>()) {
+            if(templateSpecializationType->isSugared() and not carriesNamespace) {
+                // do this only if the templateSpecializationType does not carry a nestedns
+                InsertNamespace(elaboratedType->getQualifier());
+            }
+        }
+
+        StringStream stream{};
+        stream.Print(*templateSpecializationType);
+
+        mOutputFormatHelper.Append(stream.str());
+
+        InsertTemplateArgs(*templateSpecializationType);
+
+    } else if(auto* depSpecType = underlyingType->getAs<DependentTemplateSpecializationType>()) {
+        mOutputFormatHelper.Append(GetElaboratedTypeKeyword(depSpecType->getKeyword()));
+
+#if IS_CLANG_NEWER_THAN(20)
+        InsertNamespace(depSpecType->getDependentTemplateName().getQualifier());
+
+        mOutputFormatHelper.Append(kwTemplateSpace, GetName(depSpecType->getDependentTemplateName()));
+#else
+        InsertNamespace(depSpecType->getQualifier());
+
+        mOutputFormatHelper.Append(kwTemplateSpace, depSpecType->getIdentifier()->getName());
+#endif
+
+        InsertTemplateArgs(*depSpecType);
+
+    } else {
+        mOutputFormatHelper.Append(GetName(underlyingType));
+    }
+
+    mOutputFormatHelper.AppendSemiNewLine();
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const TypedefDecl* stmt)
+{
+    /* function pointer typedefs are special. Ease up things using "using" */
+    //    outputFormatHelper.AppendNewLine("typedef ", GetName(stmt->getUnderlyingType()), " ", GetName(*stmt),
+    //    ";");
+    mOutputFormatHelper.AppendSemiNewLine(kwUsingSpace, GetName(*stmt), hlpAssing, GetName(stmt->getUnderlyingType()));
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertCXXMethodHeader(const CXXMethodDecl* stmt, OutputFormatHelper& initOutputFormatHelper)
+{
+    LAMBDA_SCOPE_HELPER(CXXMethodDecl);
+    CXXConstructorDecl* cxxInheritedCtorDecl{nullptr};
+
+    // Traverse the ctor inline init statements first to find a potential CXXInheritedCtorInitExpr. This carries the
+    // name and the type. The CXXMethodDecl above knows only the type.
+    if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(stmt)) {
+        BackupAndRestore     _{gCurrentFunction, ctor};
+        CodeGeneratorVariant codeGenerator{initOutputFormatHelper, mLambdaStack, mProcessingPrimaryTemplate};
+        codeGenerator->mCurrentVarDeclPos         = mCurrentVarDeclPos;
+        codeGenerator->mCurrentFieldPos           = mCurrentFieldPos;
+        codeGenerator->mCurrentCallExprPos        = mCurrentCallExprPos;
+        codeGenerator->mOutputFormatHelperOutside = &mOutputFormatHelper;
+
+        for(OnceTrue first{}; const auto* init : ctor->inits()) {
+            initOutputFormatHelper.AppendNewLine();
+            if(first) {
+                initOutputFormatHelper.Append(": "sv);
+            } else {
+                initOutputFormatHelper.Append(", "sv);
+            }
+
+            // in case of delegating or base initializer there is no member.
+#if 0
+            if(const auto* member = init->getMember()) {
+                initOutputFormatHelper.Append(member->getName());
+                codeGenerator->InsertCurlysIfRequired(init->getInit());
+            } else {
+                const auto* inlineInit = init->getInit();
+                bool        useCurlies{false};
+
+                if(const auto* cxxInheritedCtorInitExpr = dyn_cast_or_null<CXXInheritedCtorInitExpr>(inlineInit)) {
+                    cxxInheritedCtorDecl = cxxInheritedCtorInitExpr->getConstructor();
+
+                    // Insert the base class name only, if it is not a CXXContructorExpr and not a
+                    // CXXDependentScopeMemberExpr which already carry the type.
+                } else if(init->isBaseInitializer() and not isa<CXXConstructExpr>(inlineInit)) {
+                    initOutputFormatHelper.Append(GetUnqualifiedScopelessName(init->getBaseClass()));
+                    useCurlies = true;
+                }
+
+                codeGenerator->WrapInCurliesIfNeeded(useCurlies, [&] { codeGenerator->InsertArg(inlineInit); });
+            }
+#else
+            const auto* inlineInit = init->getInit();
+
+            // in case of delegating or base initializer there is no member.
+            if(const auto* member = init->getMember()) {
+                initOutputFormatHelper.Append(member->getName());
+
+                if(isa<ParenListExpr>(inlineInit)) {
+                    codeGenerator->WrapInParens([&] { codeGenerator->InsertArg(inlineInit); });
+                } else {
+                    codeGenerator->InsertCurlysIfRequired(inlineInit);
+                }
+
+            } else if(const auto* cxxInheritedCtorInitExpr = dyn_cast_or_null<CXXInheritedCtorInitExpr>(inlineInit)) {
+                cxxInheritedCtorDecl = cxxInheritedCtorInitExpr->getConstructor();
+
+                codeGenerator->InsertArg(inlineInit);
+
+                // Insert the base class name only, if it is not a CXXContructorExpr and not a
+                // CXXDependentScopeMemberExpr which already carry the type.
+            } else if(init->isBaseInitializer() and not isa<CXXConstructExpr>(inlineInit)) {
+                initOutputFormatHelper.Append(GetUnqualifiedScopelessName(init->getBaseClass()));
+
+                const auto braceKind = isa<ParenListExpr>(inlineInit) ? BraceKind::Parens : BraceKind::Curlys;
+
+                codeGenerator->WrapInParensOrCurlys(braceKind, [&] { codeGenerator->InsertArg(inlineInit); });
+            } else {
+                codeGenerator->InsertArg(inlineInit);
+            }
+#endif
+        }
+    }
+
+    InsertTemplateGuardBegin(stmt);
+    InsertFunctionNameWithReturnType(*stmt, cxxInheritedCtorDecl);
+}
+//-----------------------------------------------------------------------------
 
-    } else if(isa<IntegerLiteral>(subExpr) and hideImplicitCasts) {
-        InsertArg(stmt->IgnoreCasts());
+void CodeGenerator::InsertCXXMethodDecl(const CXXMethodDecl* stmt, SkipBody skipBody)
+{
+    OutputFormatHelper initOutputFormatHelper{};
+    initOutputFormatHelper.SetIndent(mOutputFormatHelper, OutputFormatHelper::SkipIndenting::Yes);
 
-        // If this is part of an explicit cast, for example a CStyleCast or static_cast, ignore it, because it
-        // belongs to the cast written by the user.
-    } else if(stmt->isPartOfExplicitCast()) {
-        // For a CStyleCast we get an AST like this:
-        //
-        // CStyleCastExpr 0x13205cdc0 'uint32_t':'unsigned int' <NoOp>
-        // `-ImplicitCastExpr 0x13205cda8 'uint32_t':'unsigned int' <IntegralCast> part_of_explicit_cast
-        //  `-CStyleCastExpr 0x13205cd70 'uint16_t':'unsigned short' <NoOp>
-        //
-        // Without filtering the `uint32_t` cast appears twice. The code below takes that into account and skips the
-        // `ImplicitCastExpr` if the sub-expression is a `CStyleCastExpr`.
-        if(isa<CStyleCastExpr>(subExpr) or isa<CXXNamedCastExpr>(subExpr)) {
-            InsertArg(subExpr);
+    const auto posBeforeFunc = mOutputFormatHelper.CurrentPos();
+
+    InsertCXXMethodHeader(stmt, initOutputFormatHelper);
+
+    if(not stmt->isUserProvided() or stmt->isExplicitlyDefaulted()) {
+        InsertTemplateGuardEnd(stmt);
+        return;
+    }
+
+    mOutputFormatHelper.Append(initOutputFormatHelper);
+
+    if(isa<CXXConversionDecl>(stmt)) {
+        if(stmt->getParent()->isLambda() and not stmt->doesThisDeclarationHaveABody()) {
+            mOutputFormatHelper.AppendNewLine();
+            WrapInCurlys([&]() {
+                mOutputFormatHelper.AppendNewLine();
+                mOutputFormatHelper.Append("  "sv, kwReturn, " "sv);
+                if(const auto* invoker = stmt->getParent()->getLambdaStaticInvoker()) {
+                    mOutputFormatHelper.AppendSemiNewLine(invoker->getName());
+                } else {
+                    mOutputFormatHelper.AppendSemiNewLine(kwOperator, "()"sv);
+                }
+            });
+        }
+    }
+
+    if((SkipBody::No == skipBody) and stmt->doesThisDeclarationHaveABody() and not stmt->isLambdaStaticInvoker()) {
+        InsertMethodBody(stmt, posBeforeFunc);
+
+    } else if(not InsertLambdaStaticInvoker(stmt) or (SkipBody::Yes == skipBody)) {
+        mOutputFormatHelper.AppendSemiNewLine();
+    }
+
+    InsertTemplateGuardEnd(stmt);
+
+    if(SkipBody::No == skipBody) {
+        mOutputFormatHelper.AppendNewLine();
+    }
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const CXXMethodDecl* stmt)
+{
+    // As per [special]/1: "Programs shall not define implicitly-declared special member functions." hide special
+    // members which are not used and with that not fully evaluated. This also hopefully removes confusion about the
+    // noexcept, which is not evaluated, if the special member is not used.
+    RETURN_IF(not GetInsightsOptions().UseShow2C and not stmt->hasBody() and not stmt->isUserProvided() and
+              not stmt->isExplicitlyDefaulted() and not stmt->isDeleted());
+
+    InsertCXXMethodDecl(stmt, SkipBody::No);
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const EnumDecl* stmt)
+{
+    mOutputFormatHelper.Append(kwEnumSpace);
+
+    if(stmt->isScoped()) {
+        if(stmt->isScopedUsingClassTag()) {
+            mOutputFormatHelper.Append(kwClassSpace);
         } else {
-            InsertArg(stmt->IgnoreCasts());
+            mOutputFormatHelper.Append(kwStructSpace);
         }
+    }
 
-    } else {
-        auto           castName{GetCastName(castKind)};
-        const QualType castDestType{[&] {
-            auto type{stmt->getType()};
+    mOutputFormatHelper.Append(stmt->getName());
 
-            // In case of a dependent type the canonical type doesn't know the parameters name.
-            if(not type->isDependentType()) {
-                type = type.getCanonicalType();
-            }
+    if(stmt->isFixed()) {
+        mOutputFormatHelper.Append(" : "sv, GetName(stmt->getIntegerType()));
+    }
 
-            // In at least the case a structured bindings the compiler adds xvalue casts but the && is missing to
-            // make it valid C++.
-            if(VK_XValue == stmt->getValueKind()) {
-                return GetGlobalAST().getRValueReferenceType(type);
-            }
+    mOutputFormatHelper.AppendNewLine();
 
-            return type;
-        }()};
+    WrapInCurlys(
+        [&]() {
+            mOutputFormatHelper.IncreaseIndent();
+            mOutputFormatHelper.AppendNewLine();
+            OnceFalse needsComma{};
 
-        FormatCast(castName, castDestType, subExpr, castKind);
+            ForEachArg(stmt->enumerators(), [&](const auto* value) {
+                if(needsComma) {
+                    mOutputFormatHelper.AppendNewLine();
+                }
+
+                InsertArg(value);
+            });
+
+            InsertArg(stmt->getBody());
+
+            mOutputFormatHelper.DecreaseIndent();
+            mOutputFormatHelper.AppendNewLine();
+        },
+        AddSpaceAtTheEnd::No);
+
+    mOutputFormatHelper.AppendSemiNewLine();
+    mOutputFormatHelper.AppendNewLine();
+}
+//-----------------------------------------------------------------------------
+
+void CodeGenerator::InsertArg(const EnumConstantDecl* stmt)
+{
+    mOutputFormatHelper.Append(stmt->getName());
+
+    InsertAttributes(stmt);
+
+    if(const auto* initExpr = stmt->getInitExpr()) {
+        mOutputFormatHelper.Append(hlpAssing);
+
+        InsertArg(initExpr);
     }
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const DeclRefExpr* stmt)
+static auto& GetRecordLayout(const RecordDecl* recordDecl)
 {
-    if(const auto* tmplObjParam = dyn_cast_or_null<TemplateParamObjectDecl>(stmt->getDecl())) {
-        mOutputFormatHelper.Append(GetName(*tmplObjParam));
+    return GetGlobalAST().getASTRecordLayout(recordDecl);
+}
+//-----------------------------------------------------------------------------
 
-    } else if(const auto* vd = dyn_cast_or_null<VarDecl>(stmt->getDecl());
-              GetInsightsOptions().UseShow2C and IsReferenceType(vd)) {
-        const auto* init = vd->getInit();
+///! The layout of a record in bytes as shown by \c --edu-show-padding.
+struct RecordLayoutSummary
+{
+    struct Field
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t padding{};  ///! Bytes between the end of this field and the next field or the end of the record.
+        ///! With \c --edu-show-cachelines, an earlier field likely written by another thread on the same cache line.
+        const FieldDecl* falseSharingWith{};
+        bool             wastesStorage{};  ///! A member of an empty class without `[[no_unique_address]]`.
+    };
 
-        if(const auto* dref = dyn_cast_or_null<DeclRefExpr>(init)) {
-            mOutputFormatHelper.Append(GetName(*dref));
-            return;
+    struct Base
+    {
+        uint64_t offset;
+        uint64_t size;
+        bool     eboBlocked{};  ///! An empty base which cannot share its address with the subobject following it.
+    };
 
-        } else if(const auto* inList = dyn_cast_or_null<InitListExpr>(init)) {
-            mOutputFormatHelper.Append(GetName(*dyn_cast_or_null<DeclRefExpr>(inList->getInit(0))));
-            return;
+    SmallVector<Field, 16> fields{};  ///! Indexed by `FieldDecl::getFieldIndex`
+    SmallVector<Base, 4>   bases{};   ///! In the order of `CXXRecordDecl::bases`
+    uint64_t               reclaimable{};  ///! Bytes used by the empty members and bases marked above.
+};
+//-----------------------------------------------------------------------------
+
+///! Atomics and mutexes are usually written by different threads.
+static bool IsLikelyWrittenConcurrently(QualType type)
+{
+    type = GetGlobalAST().getBaseElementType(type);
+
+    if(type->isAtomicType()) {
+        return true;
+    }
+
+    static constexpr std::array concurrentTypes{"atomic"sv,
+                                                "atomic_flag"sv,
+                                                "mutex"sv,
+                                                "recursive_mutex"sv,
+                                                "timed_mutex"sv,
+                                                "recursive_timed_mutex"sv,
+                                                "shared_mutex"sv,
+                                                "shared_timed_mutex"sv};
+
+    if(const auto* recordDecl = type->getAsCXXRecordDecl(); recordDecl and recordDecl->isInStdNamespace()) {
+        return ranges::find(concurrentTypes, std::string_view{recordDecl->getName()}) != concurrentTypes.end();
+    }
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+
+static bool IsEmptyRecord(QualType type)
+{
+    const auto* recordDecl = type->getAsCXXRecordDecl();
+
+    return recordDecl and recordDecl->hasDefinition() and recordDecl->isEmpty();
+}
+//-----------------------------------------------------------------------------
+
+/// \brief Find the empty members and bases of \p record which occupy storage and estimate the bytes they cost.
+///
+/// An empty member without `[[no_unique_address]]` occupies at least one byte, plus the padding the next member needs.
+/// An empty base occupies no storage, unless another subobject of the same type would end up at the same address. The
+/// Itanium ABI then moves the base, or the subobject following it, to the next free offset. A moved empty base does not
+/// count as data, it only grows the record if it ends beyond it. The costs are estimated by placing the subobjects in
+/// layout order once with and once without the wasting ones.
+static void
+CheckEmptySubobjects(const CXXRecordDecl& record, const ASTRecordLayout& recordLayout, RecordLayoutSummary& summary)
+{
+    auto& ctx = GetGlobalAST();
+
+    ///! A base, the vptr, a field or a group of adjacent bit-fields.
+    struct Unit
+    {
+        uint64_t             offset;
+        uint64_t             size;
+        uint64_t             align;
+        const CXXRecordDecl* type{};
+        bool                 wastes{};
+        bool                 bitField{};
+        bool                 extendsSizeOnly{};
+    };
+
+    SmallVector<Unit, 16> units{};
+
+    if(recordLayout.hasOwnVFPtr()) {
+        const auto pointerSize = static_cast<uint64_t>(ctx.getTypeSizeInChars(ctx.VoidPtrTy).getQuantity());
+        units.push_back({0, pointerSize, pointerSize});
+    }
+
+    for(size_t idx{}; const auto& base : record.bases()) {
+        const auto* baseDecl    = base.getType()->getAsCXXRecordDecl();
+        auto&       summaryBase = summary.bases[idx++];
+
+        if(baseDecl->isEmpty() and not base.isVirtual()) {
+            // A moved empty base occupies an address of its own.
+            if(summaryBase.offset) {
+                summaryBase.eboBlocked = true;
+                summaryBase.size       = 1;
+                units.push_back({summaryBase.offset, 1, 1, baseDecl, true});
+                units.back().extendsSizeOnly = true;
+            }
+
+            continue;
         }
+
+        const auto& baseLayout = GetRecordLayout(baseDecl);
+
+        // The tail padding of a base can be reused, only its data size counts.
+        units.push_back({summaryBase.offset,
+                         static_cast<uint64_t>(baseLayout.getDataSize().getQuantity()),
+                         static_cast<uint64_t>(baseLayout.getAlignment().getQuantity()),
+                         baseDecl});
     }
 
-    if(const auto* ctx = stmt->getDecl()->getDeclContext(); not ctx->isFunctionOrMethod() and
-                                                            not isa<NonTypeTemplateParmDecl>(stmt->getDecl()) and
-                                                            not GetInsightsOptions().UseShow2C) {
-        if(const auto* qualifier = stmt->getQualifier();
-           qualifier and (qualifier->getKind() == NestedNameSpecifier::SpecifierKind::Global)) {
-            // According to
-            // https://clang.llvm.org/doxygen/classclang_1_1NestedNameSpecifier.html#ac707a113605ed4283684b8c05664eb6f
-            // the global specifier is not stored.
-            mOutputFormatHelper.Append("::"sv, GetPlainName(*stmt));
+    for(const auto* field : record.fields()) {
+        const auto& summaryField = summary.fields[field->getFieldIndex()];
 
-        } else {
-            OutputFormatHelper   ofm{};
-            CodeGeneratorVariant codeGenerator{ofm};
+        if(0 == summaryField.size) {
+            continue;
+        }
+
+        const auto     offsetInBits = recordLayout.getFieldOffset(field->getFieldIndex());
+        const auto     type         = field->getType();
+        const uint64_t align{static_cast<uint64_t>(ctx.getDeclAlign(field).getQuantity())};
+
+        if(field->isBitField()) {
+            const uint64_t end{(offsetInBits + field->getBitWidthValue() + 7) / 8};
+
+            if(units.empty() or not units.back().bitField) {
+                units.push_back({offsetInBits / 8, 0, align});
+                units.back().bitField = true;
+            }
+
+            auto& unit = units.back();
+            unit.align = std::max(unit.align, align);
+            unit.size  = std::max(unit.offset + unit.size, end) - unit.offset;
+
+            continue;
+        }
+
+        // A reference member occupies the space of a pointer.
+        const auto sizeType = type->isReferenceType() ? ctx.getPointerType(type.getNonReferenceType()) : type;
+
+        units.push_back({summaryField.offset,
+                         static_cast<uint64_t>(ctx.getTypeInfoInChars(sizeType).Width.getQuantity()),
+                         align,
+                         ctx.getBaseElementType(type)->getAsCXXRecordDecl(),
+                         summaryField.wastesStorage});
+    }
+
+    ranges::stable_sort(units, {}, &Unit::offset);
+
+    // An empty base at offset zero blocks the subobject following it, if that one is or starts with a subobject of the
+    // same type. The following subobject is then placed later than its alignment requires.
+    const auto* pushed = [&]() -> const Unit* {
+        for(uint64_t end{}; const auto& unit : units) {
+            if(unit.extendsSizeOnly) {
+                continue;
+            }
+
+            if(unit.offset > llvm::alignTo(end, unit.align)) {
+                return &unit;
+            }
+
+            end = std::max(end, unit.offset + unit.size);
+        }
+
+        return nullptr;
+    }();
+
+    if(pushed and pushed->type) {
+        const auto* pushedType = pushed->type;
+
+        for(size_t idx{}; const auto& base : record.bases()) {
+            const auto* baseDecl    = base.getType()->getAsCXXRecordDecl();
+            auto&       summaryBase = summary.bases[idx++];
+
+            if(baseDecl->isEmpty() and not base.isVirtual() and (0 == summaryBase.offset) and
+               ((pushedType == baseDecl) or pushedType->isDerivedFrom(baseDecl))) {
+                summaryBase.eboBlocked = true;
+                summaryBase.size       = 1;
+                units.insert(units.begin(), {0, 1, 1, baseDecl, true});
+            }
+        }
+    }
+
+    RETURN_IF(ranges::none_of(units, &Unit::wastes));
 
-            codeGenerator->ParseDeclContext(ctx);
+    const uint64_t recordAlign{static_cast<uint64_t>(recordLayout.getAlignment().getQuantity())};
 
-            mOutputFormatHelper.Append(ScopeHandler::RemoveCurrentScope(ofm.GetString()), GetPlainName(*stmt));
+    auto simulatedSize = [&](bool withWasting) {
+        uint64_t offset{};
+        uint64_t size{};
+
+        for(const auto& unit : units) {
+            if(unit.extendsSizeOnly) {
+                size = std::max(size, ValueOrDefault(withWasting, unit.offset + unit.size));
+
+            } else if(withWasting or not unit.wastes) {
+                offset = llvm::alignTo(offset, unit.align) + unit.size;
+            }
         }
 
-    } else {
-        mOutputFormatHelper.Append(GetName(*stmt));
-    }
+        // Even an empty object occupies one byte.
+        return std::max<uint64_t>(llvm::alignTo(std::max(offset, size), recordAlign), 1);
+    };
 
-    if(const auto* varTmplSpecDecl = dyn_cast_or_null<VarTemplateSpecializationDecl>(stmt->getDecl())) {
-        InsertTemplateArgs(*varTmplSpecDecl);
-    } else {
-        InsertTemplateArgs(*stmt);
-    }
+    summary.reclaimable = simulatedSize(true) - simulatedSize(false);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CompoundStmt* stmt)
+/// \brief Get the layout summary of \p recordDecl, which is computed once per record.
+///
+/// `RecordDecl::fields` is a linked list, looking up the next field for each field is quadratic in the number of
+/// fields.
+static const RecordLayoutSummary& GetRecordLayoutSummary(const RecordDecl* recordDecl)
 {
-    mOutputFormatHelper.OpenScope();
-    mLifeTimeTracker.StartScope(isa_and_nonnull<FunctionDecl>(mLastDecl));
-
-    // prevent nested CompoundStmt's to insert a return on each leave. Only insert it before closing the most outer
-    // one.
-    const bool requiresImplicitReturnZero{std::exchange(mRequiresImplicitReturnZero, false)};
+    static const ASTContext* summariesAST{};
+    static llvm::DenseMap<const RecordDecl*, std::unique_ptr<RecordLayoutSummary>> summaries{};
 
-    HandleCompoundStmt(stmt);
+    // The records are only valid as long as their ASTContext.
+    if(const auto* ast = &GetGlobalAST(); ast != summariesAST) {
+        summaries.clear();
+        summariesAST = ast;
+    }
 
-    if(requiresImplicitReturnZero) {
-        InsertArg(Return(Int32(0)));
+    auto& summary = summaries[recordDecl];
 
-        if(not mSkipSemi) {
-            InsertArg(mkNullStmt());
-        }
+    if(summary) {
+        return *summary;
     }
 
-    mSkipSemi = mLifeTimeTracker.EndScope(mOutputFormatHelper, isa_and_nonnull<ReturnStmt>(mLastStmt));
+    summary                  = std::make_unique<RecordLayoutSummary>();
+    const auto& recordLayout = GetRecordLayout(recordDecl);
+    auto&       fields       = summary->fields;
 
-    mOutputFormatHelper.CloseScope(OutputFormatHelper::NoNewLineBefore::Yes);
-}
-//-----------------------------------------------------------------------------
+    const bool       showCachelines{GetInsightsOptions().UseShowCachelines};
+    const uint64_t   cachelineSize{GetInsightsOptions().CachelineSize};
+    const FieldDecl* lastConcurrentField{};
+    uint64_t         lastConcurrentLine{};
 
-template<typename... Args>
-static bool IsStmtRequiringSemi(const Stmt* stmt)
-{
-    return (... and not isa<Args>(stmt));
-}
-//-----------------------------------------------------------------------------
+    // Records made up by C++ Insights, like a coroutine frame, have no location. Their members cannot be changed, so
+    // there is nothing to suggest about empty ones.
+    const bool madeUp{recordDecl->getLocation().isInvalid()};
 
-void CodeGenerator::HandleCompoundStmt(const CompoundStmt* stmt)
-{
-    for(const auto* item : stmt->body()) {
-        InsertArg(item);
+    for(const auto* field : recordDecl->fields()) {
+        // A `[[no_unique_address]]` member of an empty class occupies no storage.
+        const bool isZeroSize{field->isZeroSize(GetGlobalAST())};
 
-        // Skip inserting a semicolon, if this is a LambdaExpr and out stack is empty. This addresses a special case
-        // #344.
-        const bool skipSemiForLambda{mLambdaStack.empty() and isa<LambdaExpr>(item)};
+        RecordLayoutSummary::Field summaryField{
+            recordLayout.getFieldOffset(field->getFieldIndex()) / 8,  // this is in bits
+            isZeroSize ? 0
+                       : static_cast<uint64_t>(
+                             GetGlobalAST().getTypeInfoInChars(GetType(field->getType())).Width.getQuantity())};
 
-        if(IsStmtRequiringSemi<IfStmt,
-                               NullStmt,
-                               ForStmt,
-                               DeclStmt,
-                               WhileStmt,
-                               DoStmt,
-                               CXXForRangeStmt,
-                               SwitchStmt,
-                               CXXTryStmt,
-                               CppInsightsCommentStmt>(item) and
-           InsertSemi() and not skipSemiForLambda and not mSkipSemi) {
-            mOutputFormatHelper.AppendSemiNewLine();
+        summaryField.wastesStorage = not madeUp and not isZeroSize and not field->isBitField() and
+                                     not recordDecl->isUnion() and IsEmptyRecord(field->getType());
+
+        // Fields with an explicit alignment are assumed to be placed on a cache line of their own on purpose.
+        if(showCachelines and IsLikelyWrittenConcurrently(field->getType()) and not field->hasAttr<AlignedAttr>()) {
+            if(lastConcurrentField and (lastConcurrentLine >= (summaryField.offset / cachelineSize))) {
+                summaryField.falseSharingWith = lastConcurrentField;
+            }
+
+            lastConcurrentField = field;
+            lastConcurrentLine  = (summaryField.offset + std::max<uint64_t>(summaryField.size, 1) - 1) / cachelineSize;
         }
 
-        mSkipSemi = false;
+        fields.push_back(summaryField);
     }
-}
-//-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertIfOrSwitchInitVariables(same_as_any_of<const IfStmt, const SwitchStmt> auto* stmt)
-{
-    if(const auto* conditionVar = stmt->getConditionVariable()) {
-        InsertArg(conditionVar);
-    }
+    const uint64_t recordSize = recordLayout.getSize().getQuantity();
 
-    if(const auto* init = stmt->getInit()) {
-        InsertArg(init);
+    // Fields can overlap, bit-fields share their storage and empty fields can be placed on top of others. Padding
+    // starts where the furthest reaching field so far ends.
+    for(uint64_t end{}; const auto idx : NumberIterator{fields.size()}) {
+        auto&      field      = fields[idx];
+        const auto nextOffset = ((idx + 1) < fields.size()) ? fields[idx + 1].offset : recordSize;
+        end                   = std::max(end, field.offset + field.size);
 
-        if(not isa<DeclStmt>(init)) {
-            mOutputFormatHelper.AppendSemiNewLine();
+        if(end < nextOffset) {
+            field.padding = nextOffset - end;
         }
     }
-}
-//-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const IfStmt* stmt)
-{
-    const bool hasInit{stmt->getInit() or stmt->getConditionVariable()};
+    if(const auto* cxxRecordDecl = dyn_cast_or_null<CXXRecordDecl>(recordDecl)) {
+        for(const auto& base : cxxRecordDecl->bases()) {
+            const auto* baseDecl = base.getType()->getAsCXXRecordDecl();
+            const auto  offset   = base.isVirtual() ? recordLayout.getVBaseClassOffset(baseDecl)
+                                                    : recordLayout.getBaseClassOffset(baseDecl);
 
-    if(hasInit) {
-        mOutputFormatHelper.OpenScope();
+            // An empty base usually shares its address with the record, it then occupies no storage.
+            summary->bases.push_back(
+                {static_cast<uint64_t>(offset.getQuantity()),
+                 baseDecl->isEmpty() ? 0 : static_cast<uint64_t>(GetRecordLayout(baseDecl).getSize().getQuantity())});
+        }
 
-        InsertIfOrSwitchInitVariables(stmt);
+        if(not madeUp and not cxxRecordDecl->isUnion()) {
+            CheckEmptySubobjects(*cxxRecordDecl, recordLayout, *summary);
+        }
     }
 
-    mOutputFormatHelper.Append("if"sv, ValueOrDefault(stmt->isConstexpr(), kwSpaceConstExpr));
-
-    WrapInParensIfNeeded(
-        not stmt->isConsteval(),
-        [&]() {
-            mShowConstantExprValue = ShowConstantExprValue::Yes;
-
-            InsertArg(stmt->getCond());
+    return *summary;
+}
+//-----------------------------------------------------------------------------
 
-            mShowConstantExprValue = ShowConstantExprValue::No;
-        },
-        AddSpaceAtTheEnd::Yes);
+///! The bytes each record could save with the layout suggested by \c --edu-suggest-layout.
+/*constinit*/ static llvm::DenseMap<const CXXRecordDecl*, uint64_t> gLayoutSavings{};
+//-----------------------------------------------------------------------------
 
-    mOutputFormatHelper.Append(ValueOrDefault(stmt->isNegatedConsteval(), " !"sv),
-                               ValueOrDefault(stmt->isConsteval(), kwSpaceConstEvalSpace));
+std::string EmitLayoutSuggestionSummary()
+{
+    std::string ret{};
 
-    WrapInCompoundIfNeeded(stmt->getThen(), AddNewLineAfter::No);
+    if(not gLayoutSavings.empty()) {
+        uint64_t totalSavings{};
 
-    // else
-    if(const auto* elsePart = stmt->getElse()) {
-        mOutputFormatHelper.Append(
-            "else "sv,
-            ValueOrDefault(stmt->isConstexpr(), StrCat(kwCCommentStartSpace, kwConstExprSpace, kwCCommentEndSpace)));
+        for(const auto& [record, savings] : gLayoutSavings) {
+            totalSavings += savings;
+        }
 
-        WrapInCompoundIfNeeded(elsePart, AddNewLineAfter::No);
+        ret = StrCat("\n/* Suggested layouts save "sv,
+                     totalSavings,
+                     " bytes in total, one object of each of the "sv,
+                     gLayoutSavings.size(),
+                     " records above */\n"sv);
     }
 
-    // Add newline after last closing curly (either from if or else if).
-    mOutputFormatHelper.AppendNewLine();
-
-    if(hasInit) {
-        mOutputFormatHelper.CloseScope();
-        mOutputFormatHelper.AppendNewLine();
-    }
+    gLayoutSavings.clear();
 
-    // one blank line after statement
-    mOutputFormatHelper.AppendNewLine();
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
-class ContinueASTTransformer : public StmtVisitor<ContinueASTTransformer>
+void CodeGenerator::InsertLayoutSuggestion(const CXXRecordDecl& record)
 {
-    Stmt*            mPrevStmt{};
-    std::string_view mContinueLabel{};
+    RETURN_IF(record.isLambda() or record.isUnion() or record.isDependentType() or record.isInvalidDecl() or
+              record.hasAttr<PackedAttr>() or record.field_empty());
 
-public:
-    bool found{};
+    auto&       ctx          = GetGlobalAST();
+    const auto& recordLayout = GetRecordLayout(&record);
 
-    ContinueASTTransformer(Stmt* stmt, std::string_view continueLabel)
-    : mPrevStmt{stmt}
-    , mContinueLabel{continueLabel}
+    ///! A field or a group of adjacent bit-fields, which is moved only as a whole.
+    struct Unit
     {
-        Visit(stmt);
-    }
+        SmallVector<const FieldDecl*, 2> fields{};
+        uint64_t                         size{};
+        uint64_t                         align{};
+        uint64_t                         startInBits{};
+        uint64_t                         endInBits{};
+    };
 
-    void Visit(Stmt* stmt)
-    {
-        if(stmt) {
-            StmtVisitor<ContinueASTTransformer>::Visit(stmt);
-        }
-    }
+    SmallVector<Unit, 16> units{};
 
-    void VisitContinueStmt(ContinueStmt* stmt)
-    {
-        found = true;
+    for(const auto* field : record.fields()) {
+        const auto     offsetInBits = recordLayout.getFieldOffset(field->getFieldIndex());
+        const auto     type         = field->getType();
+        const uint64_t align{static_cast<uint64_t>(ctx.getDeclAlign(field).getQuantity())};
 
-        ReplaceNode(mPrevStmt, stmt, Goto(mContinueLabel));
-    }
+        if(field->isBitField()) {
+            if(units.empty() or not units.back().fields.back()->isBitField() or
+               (units.back().fields.back()->getAccess() != field->getAccess())) {
+                units.push_back({{}, 0, 0, offsetInBits, offsetInBits});
+            }
 
-    void VisitStmt(Stmt* stmt)
-    {
-        auto* tmp = mPrevStmt;
-        mPrevStmt = stmt;
+            auto& unit = units.back();
+            unit.fields.push_back(field);
+            unit.align     = std::max(unit.align, align);
+            unit.endInBits = offsetInBits + field->getBitWidthValue();
+            unit.size      = ((unit.endInBits + 7) / 8) - (unit.startInBits / 8);
 
-        for(auto* child : stmt->children()) {
-            Visit(child);
+            continue;
         }
 
-        mPrevStmt = tmp;
-    }
-};
-//-----------------------------------------------------------------------------
-
-void CodeGenerator::InsertArg(const ForStmt* stmt)
-{
-    // https://github.com/vtjnash/clang-ast-builder/blob/master/AstBuilder.cpp
-    // http://clang-developers.42468.n3.nabble.com/Adding-nodes-to-Clang-s-AST-td4054800.html
-    // https://stackoverflow.com/questions/30451485/how-to-clone-or-create-an-ast-stmt-node-of-clang/38899615
+        // A reference member occupies the space of a pointer.
+        const auto sizeType = type->isReferenceType() ? ctx.getPointerType(type.getNonReferenceType()) : type;
 
-    if(GetInsightsOptions().UseAltForSyntax) {
-        auto*          rwStmt = const_cast<ForStmt*>(stmt);
-        const auto&    ctx    = GetGlobalAST();
-        StmtsContainer bodyStmts{};
+        units.push_back({{field},
+                         static_cast<uint64_t>(ctx.getTypeInfoInChars(sizeType).Width.getQuantity()),
+                         align,
+                         offsetInBits,
+                         offsetInBits});
+    }
 
-        auto       continueLabel = MakeLineColumnName(ctx.getSourceManager(), stmt->getBeginLoc(), "__continue_"sv);
-        const bool insertLabel   = ContinueASTTransformer{rwStmt->getBody(), continueLabel}.found;
+    // Bases and the vptr come before the first field, they are not moved.
+    const uint64_t dataStart{units.front().startInBits / 8};
+    const uint64_t recordAlign{static_cast<uint64_t>(recordLayout.getAlignment().getQuantity())};
 
-        bodyStmts.AddBodyStmts(rwStmt->getBody());
+    auto simulatedSize = [&](const auto& layout) {
+        uint64_t offset{dataStart};
 
-        // Build and insert the continue goto label
-        if(insertLabel) {
-            bodyStmts.Add(Label(continueLabel));
+        for(const auto* unit : layout) {
+            offset = llvm::alignTo(offset, unit->align) + unit->size;
         }
 
-        bodyStmts.Add(rwStmt->getInc());
+        return llvm::alignTo(offset, recordAlign);
+    };
 
-        auto* condition = [&]() -> Expr* {
-            if(rwStmt->getCond()) {
-                return rwStmt->getCond();
-            }
+    SmallVector<const Unit*, 16> declaredOrder{};
+    for(const auto& unit : units) {
+        declaredOrder.push_back(&unit);
+    }
 
-            return Bool(true);
-        }();
+    // Sort each block of the same access by decreasing alignment, that leaves padding only at the end.
+    auto suggestedOrder = declaredOrder;
+    auto accessOf       = [](const Unit* unit) { return unit->fields.front()->getAccess(); };
 
-        auto* outerBody = mkCompoundStmt(bodyStmts, stmt->getBeginLoc(), stmt->getEndLoc());
-        auto* whileStmt = WhileStmt::Create(
-            ctx, nullptr, condition, outerBody, stmt->getBeginLoc(), stmt->getLParenLoc(), stmt->getRParenLoc());
+    for(auto blockStart = suggestedOrder.begin(); blockStart != suggestedOrder.end();) {
+        const auto blockAccess = accessOf(*blockStart);
+        const auto blockEnd    = std::find_if(
+            blockStart, suggestedOrder.end(), [&](const Unit* unit) { return accessOf(unit) != blockAccess; });
 
-        StmtsContainer outerScopeStmts{};
-        outerScopeStmts.Add(rwStmt->getInit());
-        outerScopeStmts.Add(whileStmt);
+        std::stable_sort(blockStart, blockEnd, [](const Unit* a, const Unit* b) { return a->align > b->align; });
+        blockStart = blockEnd;
+    }
 
-        auto* outerScopeBody = mkCompoundStmt(outerScopeStmts, stmt->getBeginLoc(), stmt->getEndLoc());
+    // Compare the simulated sizes, the real layout may differ slightly for example due to tail padding reuse.
+    const auto declaredSize  = simulatedSize(declaredOrder);
+    const auto suggestedSize = simulatedSize(suggestedOrder);
+    RETURN_IF(suggestedSize >= declaredSize);
 
-        InsertArg(outerScopeBody);
-        mOutputFormatHelper.AppendNewLine();
+    const uint64_t recordSize = recordLayout.getSize().getQuantity();
+    const auto     savings    = declaredSize - suggestedSize;
+    gLayoutSavings[&record]   = savings;
 
-    } else {
-        {
-            // We need to handle the case that a lambda is used in the init-statement of the for-loop.
-            LAMBDA_SCOPE_HELPER(VarDecl);
+    mOutputFormatHelper.AppendNewLine("/* Suggested layout, size: "sv,
+                                      recordSize - savings,
+                                      " instead of "sv,
+                                      recordSize,
+                                      ", align: "sv,
+                                      recordAlign);
+    mOutputFormatHelper.AppendNewLine(GetTagDeclTypeName(record), GetName(record));
+    mOutputFormatHelper.OpenScope();
 
-            mOutputFormatHelper.Append("for"sv);
+    AccessSpecifier lastAccess{record.isClass() ? AS_private : AS_public};
 
-            WrapInParens(
-                [&]() {
-                    if(const auto* init = stmt->getInit()) {
-                        MultiStmtDeclCodeGenerator codeGenerator{
-                            mOutputFormatHelper, mLambdaStack, InsertVarDecl(nullptr)};
-                        codeGenerator.InsertArg(init);
+    for(const auto* unit : suggestedOrder) {
+        if(const auto access = accessOf(unit); lastAccess != access) {
+            lastAccess = access;
+            mOutputFormatHelper.AppendNewLine(AccessToStringWithColon(access));
+        }
 
-                    } else {
-                        mOutputFormatHelper.Append("; "sv);
-                    }
+        for(const auto* field : unit->fields) {
+            mOutputFormatHelper.Append(GetTypeNameAsParameter(field->getType(), GetName(*field)));
 
-                    InsertArg(stmt->getCond());
-                    mOutputFormatHelper.Append("; "sv);
+            if(field->isBitField()) {
+                mOutputFormatHelper.Append(':', field->getBitWidthValue());
+            }
 
-                    InsertArg(stmt->getInc());
-                },
-                AddSpaceAtTheEnd::Yes);
+            mOutputFormatHelper.AppendSemiNewLine();
         }
-
-        WrapInCompoundIfNeeded(stmt->getBody(), AddNewLineAfter::Yes);
     }
 
-    mOutputFormatHelper.AppendNewLine();
+    mOutputFormatHelper.CloseScope(OutputFormatHelper::NoNewLineBefore::Yes);
+    mOutputFormatHelper.AppendSemiNewLine();
+    mOutputFormatHelper.AppendNewLine("*/"sv);
 }
 //-----------------------------------------------------------------------------
 
-static bool IsConstQualifiedType(QualType type)
+static std::string_view GetSpecialMemberName(const CXXMethodDecl& method)
 {
-    if(not type.isNull()) {
-        if(auto* typePtr = type.getTypePtrOrNull()) {
-            if(auto pointee = typePtr->getPointeeType(); not pointee.isNull()) {
-                return pointee.isConstQualified();
-            }
+    if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(&method)) {
+        if(ctor->isDefaultConstructor()) {
+            return "default constructor"sv;
+        } else if(ctor->isCopyConstructor()) {
+            return "copy constructor"sv;
+        } else if(ctor->isMoveConstructor()) {
+            return "move constructor"sv;
         }
+
+    } else if(isa<CXXDestructorDecl>(method)) {
+        return "destructor"sv;
+
+    } else if(method.isCopyAssignmentOperator()) {
+        return "copy assignment operator"sv;
+
+    } else if(method.isMoveAssignmentOperator()) {
+        return "move assignment operator"sv;
     }
 
-    return false;
+    return {};
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CStyleCastExpr* stmt)
+///! The first user-provided special member of \p record out of \p members.
+static std::string FindUserProvided(const CXXRecordDecl& record, std::initializer_list<std::string_view> members)
 {
-    const auto     castKind     = stmt->getCastKind();
-    const QualType castDestType = stmt->getType().getCanonicalType();
-    const auto     castName     = GetCastName(
-        castKind, IsConstQualifiedType(castDestType) != IsConstQualifiedType(stmt->getSubExpr()->getType()));
+    for(const auto* method : record.methods()) {
+        if(const auto name = GetSpecialMemberName(*method); method->isUserProvided() and is_contained(members, name)) {
+            return StrCat("user-provided "sv, name);
+        }
+    }
 
-    FormatCast(castName, castDestType, stmt->getSubExpr(), castKind);
+    return {};
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXNewExpr* stmt)
+static std::string FindVirtual(const CXXRecordDecl& record)
 {
-    const auto  noEmptyInitList = mNoEmptyInitList;
-    FinalAction _{[&] { mNoEmptyInitList = noEmptyInitList; }};
-    mNoEmptyInitList = GetInsightsOptions().UseShow2C ? NoEmptyInitList::Yes : NoEmptyInitList::No;
+    for(const auto& base : record.bases()) {
+        if(base.isVirtual()) {
+            return StrCat("has virtual base "sv, GetName(base.getType()));
+        }
+    }
 
-    mOutputFormatHelper.Append("new "sv);
+    if(record.isPolymorphic()) {
+        return std::string{"has virtual functions"sv};
+    }
 
-    if(stmt->getNumPlacementArgs()) {
-        /* we have a placement new */
+    return {};
+}
+//-----------------------------------------------------------------------------
 
-        WrapInParens([&]() {
-            ForEachArg(stmt->placement_arguments(), [&](const auto& placementArg) { InsertArg(placementArg); });
-        });
+///! The first base or member of \p record whose class type does not have the trait tested by \p holds.
+static std::string FindTraitBreaker(const CXXRecordDecl&                       record,
+                                    llvm::function_ref<bool(const CXXRecordDecl&)> holds,
+                                    std::string_view                               trait)
+{
+    for(const auto& base : record.bases()) {
+        if(const auto* baseRecord = base.getType()->getAsCXXRecordDecl(); baseRecord and not holds(*baseRecord)) {
+            return StrCat("base "sv, GetName(base.getType()), " is not "sv, trait);
+        }
+    }
+
+    for(const auto* field : record.fields()) {
+        const auto type = GetGlobalAST().getBaseElementType(field->getType());
+
+        if(const auto* fieldRecord = type->getAsCXXRecordDecl(); fieldRecord and not holds(*fieldRecord)) {
+            return StrCat("member "sv, GetName(*field), " of type "sv, GetName(field->getType()), " is not "sv, trait);
+        }
     }
 
-    if(const auto* ctorExpr = stmt->getConstructExpr()) {
-        InsertArg(ctorExpr);
+    return {};
+}
+//-----------------------------------------------------------------------------
 
-    } else {
-        auto name = GetName(stmt->getAllocatedType());
+///! Whether moving a \p record cannot throw. The exception specification of an implicit or defaulted move constructor
+///! is resolved only once it is used, hence the rules for it are applied here.
+static bool IsNothrowMoveConstructible(const CXXRecordDecl& record)
+{
+    auto isNothrow = [](const CXXConstructorDecl& ctor) -> std::optional<bool> {
+        const auto* proto = ctor.getType()->castAs<FunctionProtoType>();
 
-        // Special handling for arrays. They differ from one to more dimensions.
-        if(stmt->isArray()) {
-            OutputFormatHelper   ofm{};
-            CodeGeneratorVariant codeGenerator{ofm};
+        if(ctor.isDefaulted() or isUnresolvedExceptionSpec(proto->getExceptionSpecType())) {
+            return std::nullopt;
+        }
 
-            ofm.Append('[');
-            codeGenerator->InsertArg(stmt->getArraySize().value());
-            ofm.Append(']');
+        return not ctor.isDeleted() and proto->isNothrow();
+    };
 
-            // In case of multi dimension the first dimension is the getArraySize() while the others are part of the
-            // type included in GetName(...).
-            if(Contains(name, "["sv)) {
-                InsertBefore(name, "["sv, ofm.GetString());
-            } else {
-                // here we have the single dimension case, the dimension is not part of GetName, so add it.
-                name.append(ofm);
+    const CXXConstructorDecl* copyCtor{};
+
+    for(const auto* ctor : record.ctors()) {
+        if(ctor->isImplicit()) {
+            continue;
+
+        } else if(ctor->isMoveConstructor()) {
+            if(const auto ret = isNothrow(*ctor)) {
+                return *ret;
             }
-        }
 
-        mOutputFormatHelper.Append(name);
+        } else if(ctor->isCopyConstructor()) {
+            copyCtor = ctor;
+        }
+    }
 
-        if(stmt->hasInitializer()) {
-            InsertCurlysIfRequired(stmt->getInitializer());
+    // Without a move constructor a move uses the copy constructor.
+    if(copyCtor and not record.hasUserDeclaredMoveConstructor()) {
+        if(const auto ret = isNothrow(*copyCtor)) {
+            return *ret;
         }
     }
+
+    return FindTraitBreaker(record, IsNothrowMoveConstructible, {}).empty();
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const MaterializeTemporaryExpr* stmt)
+///! Whether \p record is trivially relocatable as reported by \c __is_trivially_relocatable. For a class Clang requires
+///! that it can be passed in registers, i.e. it has a trivial, or [[clang::trivial_abi]], copy or move constructor and
+///! destructor.
+static bool IsTriviallyRelocatable(const CXXRecordDecl& record)
 {
-    // At least in case of a ternary operator wrapped inside a MaterializeTemporaryExpr parens are necessary
-    const auto* temporary = stmt->getSubExpr();
-    WrapInParensIfNeeded(isa_and_nonnull<ConditionalOperator>(temporary), [&] { InsertArg(temporary); });
+    const auto& ctx = GetGlobalAST();
+
+    return ctx.getTypeDeclType(&record).isTriviallyRelocatableType(ctx);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXOperatorCallExpr* stmt)
+void CodeGenerator::InsertTypeTraits(const CXXRecordDecl& record)
 {
-    LAMBDA_SCOPE_HELPER(OperatorCallExpr);
-
-    const auto* callee = dyn_cast_or_null<DeclRefExpr>(stmt->getCallee()->IgnoreImpCasts());
-    const bool  isCXXMethod{callee and isa<CXXMethodDecl>(callee->getDecl())};
-
-    if(2 == stmt->getNumArgs()) {
-        auto getArg = [&](unsigned idx) {
-            const auto* arg = stmt->getArg(idx);
+    RETURN_IF(record.isLambda() or record.isDependentType() or record.isInvalidDecl());
 
-            // In show all casts mode don't filter this. It shows how the compiler adds const to arguments, if the
-            // argument is non-const but the parameter demands a const object
-            if(not GetInsightsOptions().ShowAllImplicitCasts) {
-                arg = arg->IgnoreImpCasts();
+    ///! The first reason which is not empty.
+    auto firstOf = [](std::initializer_list<std::string> reasons) -> std::string {
+        for(const auto& reason : reasons) {
+            if(not reason.empty()) {
+                return reason;
             }
+        }
 
-            return dyn_cast_or_null<DeclRefExpr>(arg);
-        };
-
-        const auto* param1 = getArg(0);
-        const auto* param2 = getArg(1);
+        return {};
+    };
 
-        if(callee and param1 and param2) {
-            const std::string replace = [&]() {
-                // If the argument is a variable template, add the template arguments to the parameter name.
-                auto nameWithTmplArguments = [](const auto param) {
-                    return FormatVarTemplateSpecializationDecl(param->getDecl(), GetName(*param));
-                };
+    auto insertTrait = [&](std::string_view trait, bool holds, auto&& reason) {
+        mOutputFormatHelper.Append("   "sv, trait, ": "sv);
 
-                if(isa<CXXMethodDecl>(callee->getDecl())) {
-                    return StrCat(nameWithTmplArguments(param1),
-                                  "."sv,
-                                  GetName(*callee),
-                                  "("sv,
-                                  nameWithTmplArguments(param2),
-                                  ")"sv);
-                } else {
-                    return StrCat(GetName(*callee),
-                                  "("sv,
-                                  nameWithTmplArguments(param1),
-                                  ", "sv,
-                                  nameWithTmplArguments(param2),
-                                  ")"sv);
-                }
-            }();
+        if(holds) {
+            mOutputFormatHelper.AppendNewLine("yes"sv);
+            return;
+        }
 
-            mOutputFormatHelper.Append(replace);
+        mOutputFormatHelper.Append("no"sv);
 
-            return;
+        if(const std::string why{reason()}; not why.empty()) {
+            mOutputFormatHelper.Append(", "sv, why);
         }
-    }
 
-    auto        cb           = stmt->child_begin();
-    const auto* fallbackArg0 = stmt->getArg(0);
+        mOutputFormatHelper.AppendNewLine();
+    };
 
-    // arg0 := operator
-    // skip arg0
-    std::advance(cb, 1);
+    auto findInClassInit = [&]() -> std::string {
+        for(const auto* field : record.fields()) {
+            if(field->hasInClassInitializer()) {
+                return StrCat("default member initializer of "sv, GetName(*field));
+            }
+        }
 
-    const auto* arg1 = *cb;
+        return {};
+    };
 
-    std::advance(cb, 1);
+    auto findMixedAccess = [&]() -> std::string {
+        for(const auto* field : record.fields()) {
+            if(field->getAccess() != (*record.field_begin())->getAccess()) {
+                return StrCat("members with different access, "sv,
+                              GetName(*field),
+                              " is "sv,
+                              getAccessSpelling(field->getAccess()));
+            }
+        }
 
-    // operators in a namespace but outside a class so operator goes first
-    if(not isCXXMethod) {
-        // happens for UnresolvedLooupExpr
-        if(not callee) {
-            if(const auto* adl = dyn_cast_or_null<UnresolvedLookupExpr>(stmt->getCallee())) {
-                InsertArg(adl);
+        return {};
+    };
+
+    auto findMoveCtor = [&]() -> std::string {
+        for(const auto* ctor : record.ctors()) {
+            if(not ctor->isImplicit() and ctor->isMoveConstructor()) {
+                return std::string{"move constructor is not noexcept"sv};
             }
-        } else {
-            mOutputFormatHelper.Append(GetName(*callee));
         }
 
-        mOutputFormatHelper.Append("("sv);
-    }
+        if(record.hasUserDeclaredCopyConstructor()) {
+            return std::string{"no move constructor, the copy constructor is not noexcept"sv};
+        }
 
-    // insert the arguments
-    if(isa<DeclRefExpr>(fallbackArg0)) {
-        InsertArgWithParensIfNeeded(fallbackArg0);
+        return {};
+    };
 
-    } else {
-        InsertArgWithParensIfNeeded(arg1);
-    }
+    // A class whose copy and move constructors are all deleted is never passed in registers.
+    auto findNoCopyOrMove = [&]() -> std::string {
+        auto isUsable = [](const CXXConstructorDecl* ctor) {
+            return ctor->isCopyOrMoveConstructor() and not ctor->isDeleted();
+        };
 
-    // if it is a class operator the operator follows now
-    if(isCXXMethod) {
-        const OverloadedOperatorKind opKind = stmt->getOperator();
+        if(ranges::any_of(record.ctors(), isUsable) or
+           (record.needsImplicitCopyConstructor() and not record.defaultedCopyConstructorIsDeleted()) or
+           (record.needsImplicitMoveConstructor() and not record.defaultedMoveConstructorIsDeleted())) {
+            return {};
+        }
 
-        const std::string_view operatorKw{ValueOr((OO_Coawait == opKind), kwOperatorSpace, kwOperator)};
+        return std::string{"all copy and move constructors are deleted"sv};
+    };
 
-        mOutputFormatHelper.Append("."sv, operatorKw, getOperatorSpelling(opKind), "("sv);
-    }
+    mOutputFormatHelper.AppendNewLine("/* Type traits of "sv, GetName(record), ":"sv);
+
+    insertTrait("trivially copyable"sv, record.isTriviallyCopyable(), [&] {
+        return firstOf({FindVirtual(record),
+                        FindUserProvided(record,
+                                         {"copy constructor"sv,
+                                          "move constructor"sv,
+                                          "copy assignment operator"sv,
+                                          "move assignment operator"sv,
+                                          "destructor"sv}),
+                        FindTraitBreaker(
+                            record,
+                            [](const CXXRecordDecl& r) { return r.isTriviallyCopyable(); },
+                            "trivially copyable"sv)});
+    });
 
-    // consume all remaining arguments
-    const auto childRange = llvm::make_range(cb, stmt->child_end());
+    insertTrait("trivially destructible"sv, record.hasTrivialDestructor(), [&] {
+        return firstOf({FindUserProvided(record, {"destructor"sv}),
+                        FindTraitBreaker(
+                            record,
+                            [](const CXXRecordDecl& r) { return r.hasTrivialDestructor(); },
+                            "trivially destructible"sv)});
+    });
 
-    // at least the call-operator can have more than 2 parameters
-    ForEachArg(childRange, [&](const auto& child) {
-        if(not isCXXMethod) {
-            // in global operators we need to separate the two parameters by comma
-            mOutputFormatHelper.Append(", "sv);
-        }
+    insertTrait("trivially default constructible"sv, record.hasTrivialDefaultConstructor(), [&] {
+        return firstOf({ValueOrDefault(not record.hasDefaultConstructor(), std::string{"has no default constructor"sv}),
+                        FindUserProvided(record, {"default constructor"sv}),
+                        FindVirtual(record),
+                        findInClassInit(),
+                        FindTraitBreaker(
+                            record,
+                            [](const CXXRecordDecl& r) { return r.hasTrivialDefaultConstructor(); },
+                            "trivially default constructible"sv)});
+    });
 
-        InsertArg(child);
+    insertTrait("nothrow move constructible"sv, IsNothrowMoveConstructible(record), [&] {
+        return firstOf(
+            {findMoveCtor(), FindTraitBreaker(record, IsNothrowMoveConstructible, "nothrow move constructible"sv)});
     });
 
-    mOutputFormatHelper.Append(')');
+    insertTrait("standard layout"sv, record.isStandardLayout(), [&] {
+        return firstOf({FindVirtual(record),
+                        findMixedAccess(),
+                        FindTraitBreaker(
+                            record,
+                            [](const CXXRecordDecl& r) { return r.isStandardLayout(); },
+                            "standard layout"sv)});
+    });
+
+    insertTrait("trivially relocatable"sv, IsTriviallyRelocatable(record), [&] {
+        return firstOf({FindVirtual(record),
+                        FindUserProvided(record, {"copy constructor"sv, "move constructor"sv, "destructor"sv}),
+                        findNoCopyOrMove(),
+                        FindTraitBreaker(record, IsTriviallyRelocatable, "trivially relocatable"sv)});
+    });
+
+    mOutputFormatHelper.AppendNewLine("*/"sv);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const LambdaExpr* stmt)
+///! Whether a call to \p function cannot throw. The exception specification of an implicit special member is resolved
+///! only once it is used, hence the rules for it are applied here.
+static bool IsNothrowCall(const FunctionDecl& function)
 {
-    if(not mLambdaStack.empty()) {
-        const bool insertName{mLambdaStack.back().insertName()};
+    if(function.getBuiltinID() or function.hasAttr<NoThrowAttr>()) {
+        return true;
+    }
 
-        HandleLambdaExpr(stmt, mLambdaStack.back());
+    const auto* proto = function.getType()->getAs<FunctionProtoType>();
 
-        if(insertName) {
-            mOutputFormatHelper.Append(GetLambdaName(*stmt));
-        }
+    if(nullptr == proto) {
+        return false;
 
-    } else if(LambdaInInitCapture::Yes == mLambdaInitCapture) {
-        LAMBDA_SCOPE_HELPER(InitCapture);
-        HandleLambdaExpr(stmt, mLambdaStack.back());
-    } else {
-        LAMBDA_SCOPE_HELPER(LambdaExpr);
-        HandleLambdaExpr(stmt, mLambdaStack.back());
-    }
+    } else if(not isUnresolvedExceptionSpec(proto->getExceptionSpecType())) {
+        return proto->isNothrow();
 
-    if(not mLambdaStack.empty()) {
-        mLambdaStack.back().insertInits(mOutputFormatHelper);
+    } else if(function.isTrivial() or isa<CXXDestructorDecl>(function)) {
+        return true;
+
+    } else if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(&function); ctor and ctor->isMoveConstructor()) {
+        return IsNothrowMoveConstructible(*ctor->getParent());
     }
-}
-//-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXThisExpr*)
-{
-    mOutputFormatHelper.Append(kwThis);
+    return false;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXBindTemporaryExpr* stmt)
+///! Whether an indirect call through an expression of \p type cannot throw.
+static bool IsNothrowCallee(QualType type)
 {
-    InsertArg(stmt->getSubExpr());
+    if(const auto* pointerType = type->getAs<PointerType>()) {
+        type = pointerType->getPointeeType();
+    }
+
+    const auto* proto = type->getAs<FunctionProtoType>();
+
+    return proto and proto->isNothrow();
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXFunctionalCastExpr* stmt)
+///! The name of \p function together with its parameter types, which tells overloads apart.
+static std::string GetSignature(const FunctionDecl& function)
 {
-    const bool isConstructor{isa<CXXConstructExpr>(stmt->getSubExpr())};
-    const bool isStdListInit{isa<CXXStdInitializerListExpr>(stmt->getSubExpr())};
-    const bool isListInitialization{stmt->getLParenLoc().isInvalid()};
-    const bool needsParens{not isConstructor and not isListInitialization and not isStdListInit};
+    std::string ret{StrCat(function.getQualifiedNameAsString(), "("sv)};
 
-    // If a constructor follows we do not need to insert the type name. This would insert it twice.
-    if(not isConstructor and not isStdListInit) {
-        mOutputFormatHelper.Append(GetName(stmt->getTypeAsWritten()));
+    for(OnceTrue first{}; const auto* param : function.parameters()) {
+        ret.append(StrCat(ValueOrDefault(not first, ", "sv), GetName(param->getType())));
     }
 
-    WrapInParensIfNeeded(needsParens, [&] { InsertArg(stmt->getSubExpr()); });
-}
-//-----------------------------------------------------------------------------
+    ret.append(")"sv);
 
-void CodeGenerator::InsertArg(const CXXBoolLiteralExpr* stmt)
-{
-    mOutputFormatHelper.Append(details::ConvertToBoolString(stmt->getValue()));
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const GNUNullExpr* /*stmt*/)
+///! Collects what can make a function body throw and which locals a throw has to destroy on its way out.
+class ExceptionCostFinder
 {
-    mOutputFormatHelper.Append(kwNull);
-}
-//-----------------------------------------------------------------------------
+public:
+    ///! The callees which can throw, a throw expression or an indirect call. Ignores what a `catch(...)` stops.
+    SmallVector<std::string, 4> throwing{};
+    ///! Locals with a non-trivial destructor and the number of potentially-throwing calls they live across. Each
+    ///! requires a cleanup landing pad.
+    llvm::MapVector<const VarDecl*, unsigned> cleanups{};
+    ///! The same for the temporaries with a non-trivial destructor, they live until the end of the full-expression.
+    llvm::MapVector<const CXXBindTemporaryExpr*, unsigned> temporaryCleanups{};
+
+    void Find(const Stmt* stmt)
+    {
+        if((nullptr == stmt) or isa<UnaryExprOrTypeTraitExpr, CXXNoexceptExpr>(stmt)) {
+            return;
 
-void CodeGenerator::InsertArg(const CharacterLiteral* stmt)
-{
-    StringStream stream{};
-    stream.Print(*stmt);
+        } else if(const auto* typeidExpr = dyn_cast_or_null<CXXTypeidExpr>(stmt);
+                  typeidExpr and not typeidExpr->isPotentiallyEvaluated()) {
+            return;
 
-    auto str = std::move(stream.str());
+        } else if(const auto* lambdaExpr = dyn_cast_or_null<LambdaExpr>(stmt)) {
+            // The body of the closure is a function on its own, only the captures are initialized here.
+            for(const auto* init : lambdaExpr->capture_inits()) {
+                Find(init);
+            }
 
-    if(str == "'\\x00'"sv) {
-        str = "'\\0'"sv;
-    } else if(str == "'\\xff'"sv) {
-        str = "255"sv;
-    }
+            return;
 
-    mOutputFormatHelper.Append(str);
-}
-//-----------------------------------------------------------------------------
+        } else if(const auto* declStmt = dyn_cast_or_null<DeclStmt>(stmt)) {
+            // A local is destroyed by a throw only once its initialization is complete.
+            for(const auto* decl : declStmt->decls()) {
+                if(const auto* var = dyn_cast_or_null<VarDecl>(decl)) {
+                    Find(var->getInit());
 
-void CodeGenerator::InsertArg(const PredefinedExpr* stmt)
-{
-    // Check if getFunctionName returns a valid StringLiteral. It does return a nullptr, if this PredefinedExpr is
-    // in a UnresolvedLookupExpr. In that case, print the identifier, e.g. __func__.
-    if(const auto* functionName = stmt->getFunctionName()) {
-        InsertArg(functionName);
-    } else {
-        const auto name = PredefinedExpr::getIdentKindName(stmt->getIdentKind());
+                    if(var->hasLocalStorage() and (QualType::DK_cxx_destructor == var->getType().isDestructedType())) {
+                        mLive.push_back(var);
+                    }
+                }
+            }
 
-        mOutputFormatHelper.Append(name);
-    }
-}
-//-----------------------------------------------------------------------------
+            return;
+
+        } else if(const auto* tryStmt = dyn_cast_or_null<CXXTryStmt>(stmt)) {
+            bool catchesAll{};
+
+            for(const auto idx : NumberIterator{tryStmt->getNumHandlers()}) {
+                catchesAll |= (nullptr == tryStmt->getHandler(idx)->getExceptionDecl());
+            }
+
+            mCatchAll += catchesAll;
+            Find(tryStmt->getTryBlock());
+            mCatchAll -= catchesAll;
+
+            for(const auto idx : NumberIterator{tryStmt->getNumHandlers()}) {
+                Find(tryStmt->getHandler(idx)->getHandlerBlock());
+            }
+
+            return;
+        }
+
+        // The locals of a compound statement, or of the init-statement of an if or for, end with it.
+        const auto live            = mLive.size();
+        const auto liveTemporaries = mLiveTemporaries.size();
+
+        for(const auto* child : stmt->children()) {
+            Find(child);
+        }
+
+        if(const auto* callExpr = dyn_cast_or_null<CallExpr>(stmt)) {
+            if(const auto* callee = callExpr->getDirectCallee()) {
+                if(not IsNothrowCall(*callee)) {
+                    PotentiallyThrowing(GetSignature(*callee));
+                }
+
+            } else if(not IsNothrowCallee(callExpr->getCallee()->getType())) {
+                PotentiallyThrowing("an indirect call"sv);
+            }
+
+        } else if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(stmt)) {
+            if(const auto* ctor = ctorExpr->getConstructor(); not IsNothrowCall(*ctor)) {
+                PotentiallyThrowing(GetSignature(*ctor));
+            }
+
+        } else if(const auto* newExpr = dyn_cast_or_null<CXXNewExpr>(stmt)) {
+            if(const auto* operatorNew = newExpr->getOperatorNew(); operatorNew and not IsNothrowCall(*operatorNew)) {
+                PotentiallyThrowing(GetSignature(*operatorNew));
+            }
+
+        } else if(isa<CXXThrowExpr>(stmt)) {
+            PotentiallyThrowing("a throw expression"sv);
+        }
 
-void CodeGenerator::InsertArg(const ExprWithCleanups* stmt)
-{
-    mLifeTimeTracker.StartScope(false);
-    TemporaryDeclFinder temporaryFinder{*this, not mProcessingVarDecl ? stmt->getSubExpr() : nullptr};
+        mLive.resize(live);
 
-    InsertArg(stmt->getSubExpr());
+        if(isa<ExprWithCleanups>(stmt) or not isa<Expr>(stmt)) {
+            // The temporaries of a full-expression are destroyed at its end.
+            mLiveTemporaries.resize(liveTemporaries);
 
-    if(GetInsightsOptions().ShowLifetime and not mProcessingVarDecl) {
-        mOutputFormatHelper.AppendSemiNewLine();
+        } else if(const auto* bindExpr = dyn_cast_or_null<CXXBindTemporaryExpr>(stmt)) {
+            // Like a local, a temporary is destroyed by a throw only once it is constructed.
+            mLiveTemporaries.push_back(bindExpr);
+        }
     }
 
-    mSkipSemi = mLifeTimeTracker.EndScope(mOutputFormatHelper, false);
-}
+private:
+    SmallVector<const VarDecl*, 8>              mLive{};
+    SmallVector<const CXXBindTemporaryExpr*, 8> mLiveTemporaries{};
+    unsigned                                    mCatchAll{};
+
+    void PotentiallyThrowing(std::string_view what)
+    {
+        for(const auto* var : mLive) {
+            ++cleanups[var];
+        }
+
+        for(const auto* temporary : mLiveTemporaries) {
+            ++temporaryCleanups[temporary];
+        }
+
+        if((0 == mCatchAll) and not is_contained(throwing, what)) {
+            throwing.emplace_back(what);
+        }
+    }
+};
 //-----------------------------------------------------------------------------
 
-std::string CodeGenerator::GetValueOfValueInit(const QualType& t)
+static std::string GetExceptionCosts(const FunctionDecl& function)
 {
-    const QualType& type = t.getCanonicalType();
+    ExceptionCostFinder finder{};
 
-    if(type->isScalarType()) {
-        switch(type->getScalarTypeKind()) {
-            case Type::STK_CPointer:
-            case Type::STK_BlockPointer:
-            case Type::STK_ObjCObjectPointer:
-            case Type::STK_MemberPointer: return std::string{kwNullptr};
+    // A constructor initializes its bases and members before the body.
+    if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(&function)) {
+        for(const auto* init : ctor->inits()) {
+            finder.Find(init->getInit());
+        }
+    }
 
-            case Type::STK_Bool: return std::string{kwFalse};
+    finder.Find(function.getBody());
 
-            case Type::STK_Integral:
-            case Type::STK_Floating:
-                if(const auto* bt = type->getAs<BuiltinType>()) {
-                    switch(bt->getKind()) {
-                            // Type::STK_Integral
-                        case BuiltinType::Char_U:
-                        case BuiltinType::UChar:
-                        case BuiltinType::Char_S:
-                        case BuiltinType::SChar: return "'\\0'";
-                        case BuiltinType::WChar_U:
-                        case BuiltinType::WChar_S: return "L'\\0'";
-                        case BuiltinType::Char16: return "u'\\0'";
-                        case BuiltinType::Char32: return "U'\\0'";
-                        // Type::STK_Floating
-                        case BuiltinType::Half:
-                        case BuiltinType::Float: return "0.0f";
-                        case BuiltinType::Double: return "0.0";
-                        default: break;
-                    }
-                }
+    const bool  isNothrow{IsNothrowCall(function)};
+    std::string ret{StrCat("   "sv, GetSignature(function), ": "sv)};
 
-                break;
+    if(finder.throwing.empty()) {
+        ret.append(ValueOr(isNothrow or function.isMain(), "cannot throw"sv, "cannot throw, could be noexcept"sv));
 
-            case Type::STK_FloatingComplex:
-            case Type::STK_IntegralComplex:
-                if(const auto* complexType = type->getAs<ComplexType>()) {
-                    return GetValueOfValueInit(complexType->getElementType());
-                }
+    } else {
+        static constexpr size_t maxNames{3};
+        const auto&             throwing = finder.throwing;
 
-                break;
+        ret.append(StrCat(ValueOrDefault(isNothrow, "noexcept, but "sv), "can throw through "sv));
 
-            case Type::STK_FixedPoint: Error("STK_FixedPoint is not implemented"); break;
+        for(OnceTrue first{}; const auto& what : ArrayRef<std::string>{throwing}.take_front(maxNames)) {
+            ret.append(StrCat(ValueOrDefault(not first, ", "sv), what));
         }
 
-    } else if(const auto* tt = dyn_cast_or_null<ConstantArrayType>(t.getTypePtrOrNull())) {
-        const auto&       elementType{tt->getElementType()};
-        const std::string elementTypeInitValue{GetValueOfValueInit(elementType)};
+        if(throwing.size() > maxNames) {
+            ret.append(StrCat(" and "sv, throwing.size() - maxNames, " more"sv));
+        }
 
-        return FillConstantArray(tt, elementTypeInitValue, uint64_t{0});
+        if(isNothrow) {
+            ret.append(", a throw ends in std::terminate"sv);
+        }
     }
 
-    return std::string{"0"sv};
-}
-//-----------------------------------------------------------------------------
+    OnceTrue firstCleanup{};
+    auto     appendCleanup = [&](std::string_view name, unsigned calls) {
+        ret.append(StrCat(ValueOr(firstCleanup, ", cleanup landing pads for "sv, ", "sv),
+                          name,
+                          " ("sv,
+                          calls,
+                          ValueOr(1 == calls, " call)"sv, " calls)"sv)));
+    };
 
-void CodeGenerator::InsertArg(const ImplicitValueInitExpr* stmt)
-{
-    mOutputFormatHelper.Append(GetValueOfValueInit(stmt->getType()));
-}
-//-----------------------------------------------------------------------------
+    for(const auto& [var, calls] : finder.cleanups) {
+        appendCleanup(GetName(*var), calls);
+    }
 
-void CodeGenerator::InsertArg(const CXXScalarValueInitExpr* stmt)
-{
-    mOutputFormatHelper.Append(GetName(stmt->getType()), "()"sv);
+    for(const auto& [temporary, calls] : finder.temporaryCleanups) {
+        appendCleanup(StrCat("a temporary "sv, GetName(temporary->getType())), calls);
+    }
+
+    ret.append("\n"sv);
+
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXTryStmt* stmt)
+///! Whether move assigning a \p record cannot throw, see \ref IsNothrowMoveConstructible.
+static bool IsNothrowMoveAssignable(const CXXRecordDecl& record)
 {
-    mOutputFormatHelper.AppendNewLine(kwTrySpace);
+    auto isNothrow = [](const CXXMethodDecl& method) -> std::optional<bool> {
+        const auto* proto = method.getType()->castAs<FunctionProtoType>();
 
-    InsertArg(stmt->getTryBlock());
+        if(method.isDefaulted() or isUnresolvedExceptionSpec(proto->getExceptionSpecType())) {
+            return std::nullopt;
+        }
 
-    for(const auto& i : NumberIterator{stmt->getNumHandlers()}) {
-        InsertArg(stmt->getHandler(i));
-    }
+        return not method.isDeleted() and proto->isNothrow();
+    };
 
-    mOutputFormatHelper.AppendNewLine();
-}
-//-----------------------------------------------------------------------------
+    const CXXMethodDecl* copyAssignment{};
 
-void CodeGenerator::InsertArg(const CXXCatchStmt* stmt)
-{
-    mOutputFormatHelper.Append(" catch"sv);
+    for(const auto* method : record.methods()) {
+        if(method->isImplicit()) {
+            continue;
 
-    WrapInParens(
-        [&]() {
-            if(not stmt->getCaughtType().isNull()) {
-                mOutputFormatHelper.Append(
-                    GetTypeNameAsParameter(stmt->getCaughtType(), stmt->getExceptionDecl()->getName()));
-            } else {
-                mOutputFormatHelper.Append(kwElipsis);
+        } else if(method->isMoveAssignmentOperator()) {
+            if(const auto ret = isNothrow(*method)) {
+                return *ret;
             }
-        },
-        AddSpaceAtTheEnd::Yes);
 
-    InsertArg(stmt->getHandlerBlock());
-}
-//-----------------------------------------------------------------------------
+        } else if(method->isCopyAssignmentOperator()) {
+            copyAssignment = method;
+        }
+    }
 
-void CodeGenerator::InsertArg(const CXXThrowExpr* stmt)
-{
-    mOutputFormatHelper.Append("throw "sv);
+    // Without a move assignment operator a move uses the copy assignment operator.
+    if(copyAssignment and not record.hasUserDeclaredMoveAssignment()) {
+        if(const auto ret = isNothrow(*copyAssignment)) {
+            return *ret;
+        }
+    }
 
-    InsertArg(stmt->getSubExpr());
+    return FindTraitBreaker(record, IsNothrowMoveAssignable, {}).empty();
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const ConstantExpr* stmt)
+///! Whether \p record can be copy constructed, otherwise containers have to move even with a throwing move constructor.
+static bool HasCopyConstructor(const CXXRecordDecl& record)
 {
-    if((ShowConstantExprValue::Yes == mShowConstantExprValue) and stmt->hasAPValueResult()) {
-        if(const auto value = stmt->getAPValueResult(); value.isInt()) {
-            mOutputFormatHelper.Append(value.getInt());
-            return;
+    // This includes an implicit copy constructor, once Sema declared it.
+    for(const auto* ctor : record.ctors()) {
+        if(ctor->isCopyConstructor()) {
+            return not ctor->isDeleted();
         }
     }
 
-    InsertArg(stmt->getSubExpr());
+    // A user-declared move operation deletes the implicit copy constructor.
+    if(record.hasUserDeclaredMoveConstructor() or record.hasUserDeclaredMoveAssignment()) {
+        return false;
+    }
+
+    // Sema computes this only for records which need no overload resolution to find the copy constructors of their
+    // bases and members. Otherwise it is derived from them.
+    if(not record.needsOverloadResolutionForCopyConstructor()) {
+        return not record.defaultedCopyConstructorIsDeleted();
+    }
+
+    return FindTraitBreaker(record, HasCopyConstructor, {}).empty();
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const TypeAliasDecl* stmt)
+///! The move operations of \p record which are not noexcept.
+static std::string GetMoveExceptionCosts(const CXXRecordDecl& record)
 {
-    const auto& underlyingType = stmt->getUnderlyingType();
-
-    LAMBDA_SCOPE_HELPER(Decltype);
-    P0315Visitor dt{*this};
-    dt.TraverseType(underlyingType);
-
-    mOutputFormatHelper.Append(kwUsingSpace, GetName(*stmt), hlpAssing);
+    std::string ret{};
 
-    if(auto* templateSpecializationType = underlyingType->getAs<TemplateSpecializationType>()) {
-        const bool carriesNamespace{[&] {
-            if(const auto tn = templateSpecializationType->getTemplateName();
-               (TemplateName::QualifiedTemplate == tn.getKind()) or (TemplateName::DependentTemplate == tn.getKind())) {
-                const auto* qtn = tn.getAsQualifiedTemplateName();
+    ///! Report a \p member which is not noexcept, with the member of \p record causing it if it is not user-provided.
+    auto insertMember = [&](std::string_view                               member,
+                            llvm::function_ref<bool(const CXXRecordDecl&)> holds,
+                            std::string_view                               trait,
+                            std::string_view                               consequence) {
+        const CXXMethodDecl* userDeclared{};
 
-                return qtn->getQualifier() != nullptr;
+        for(const auto* method : record.methods()) {
+            if(not method->isImplicit() and (GetSpecialMemberName(*method) == member)) {
+                userDeclared = method;
             }
+        }
 
-            return false;
-        }()};
+        RETURN_IF((userDeclared and userDeclared->isDeleted()) or holds(record));
 
-        if(const auto* elaboratedType = underlyingType->getAs<ElaboratedType>()) {
-            if(templateSpecializationType->isSugared() and not carriesNamespace) {
-                // do this only if the templateSpecializationType does not carry a nestedns
-                InsertNamespace(elaboratedType->getQualifier());
+        ret.append(StrCat("   "sv, GetName(record), ": "sv, member, " is not noexcept"sv));
+
+        if(not userDeclared or not userDeclared->isUserProvided()) {
+            if(const auto breaker = FindTraitBreaker(record, holds, trait); not breaker.empty()) {
+                ret.append(StrCat(", "sv, breaker));
             }
         }
 
-        StringStream stream{};
-        stream.Print(*templateSpecializationType);
+        ret.append(StrCat(", "sv, consequence, "\n"sv));
+    };
 
-        mOutputFormatHelper.Append(stream.str());
+    if(record.hasMoveConstructor()) {
+        insertMember("move constructor"sv,
+                     IsNothrowMoveConstructible,
+                     "nothrow move constructible"sv,
+                     ValueOr(HasCopyConstructor(record),
+                             "std::vector copies instead of moving"sv,
+                             "std::vector moves without the strong exception guarantee"sv));
+    }
 
-        InsertTemplateArgs(*templateSpecializationType);
+    if(record.hasMoveAssignment()) {
+        insertMember("move assignment operator"sv,
+                     IsNothrowMoveAssignable,
+                     "nothrow move assignable"sv,
+                     "std::swap is not noexcept"sv);
+    }
 
-    } else if(auto* depSpecType = underlyingType->getAs<DependentTemplateSpecializationType>()) {
-        mOutputFormatHelper.Append(GetElaboratedTypeKeyword(depSpecType->getKeyword()));
+    return ret;
+}
+//-----------------------------------------------------------------------------
 
-#if IS_CLANG_NEWER_THAN(20)
-        InsertNamespace(depSpecType->getDependentTemplateName().getQualifier());
+std::string EmitExceptionCostReport()
+{
+    std::string costs{};
 
-        mOutputFormatHelper.Append(kwTemplateSpace, GetName(depSpecType->getDependentTemplateName()));
-#else
-        InsertNamespace(depSpecType->getQualifier());
+    for(const auto* decl : gExceptionCostDecls) {
+        if(const auto* function = dyn_cast_or_null<FunctionDecl>(decl)) {
+            costs.append(GetExceptionCosts(*function));
 
-        mOutputFormatHelper.Append(kwTemplateSpace, depSpecType->getIdentifier()->getName());
-#endif
+        } else if(const auto* record = dyn_cast_or_null<CXXRecordDecl>(decl)) {
+            costs.append(GetMoveExceptionCosts(*record));
+        }
+    }
 
-        InsertTemplateArgs(*depSpecType);
+    gExceptionCostDecls.clear();
 
-    } else {
-        mOutputFormatHelper.Append(GetName(underlyingType));
+    if(costs.empty()) {
+        return {};
     }
 
-    mOutputFormatHelper.AppendSemiNewLine();
+    return StrCat("\n/* Exception costs:\n"sv, costs, "*/\n"sv);
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const TypedefDecl* stmt)
+///! The allocation done by a call to \p callee, if it is an allocation function or a factory of a smart pointer.
+static std::string GetAllocatingCall(const FunctionDecl& callee)
 {
-    /* function pointer typedefs are special. Ease up things using "using" */
-    //    outputFormatHelper.AppendNewLine("typedef ", GetName(stmt->getUnderlyingType()), " ", GetName(*stmt),
-    //    ";");
-    mOutputFormatHelper.AppendSemiNewLine(kwUsingSpace, GetName(*stmt), hlpAssing, GetName(stmt->getUnderlyingType()));
+    static constexpr std::array allocators{"malloc"sv, "calloc"sv, "realloc"sv, "aligned_alloc"sv};
+    static constexpr std::array factories{"make_shared"sv,
+                                          "make_shared_for_overwrite"sv,
+                                          "allocate_shared"sv,
+                                          "make_unique"sv,
+                                          "make_unique_for_overwrite"sv};
+
+    if(is{callee.getOverloadedOperator()}.any_of(OO_New, OO_Array_New)) {
+        return callee.getQualifiedNameAsString();
+    }
+
+    const auto* identifier = callee.getIdentifier();
+
+    if(nullptr == identifier) {
+        return {};
+    }
+
+    const std::string_view name{identifier->getName()};
+
+    if(callee.isExternC() and is_contained(allocators, name)) {
+        return std::string{name};
+
+    } else if(callee.isInStdNamespace() and is_contained(factories, name)) {
+        std::string ret{StrCat("std::"sv, name)};
+
+        if(const auto* args = callee.getTemplateSpecializationArgs();
+           args and (0 != args->size()) and (TemplateArgument::Type == args->get(0).getKind())) {
+            ret.append(StrCat("<"sv, GetName(args->get(0).getAsType()), ">"sv));
+        }
+
+        return ret;
+    }
+
+    return {};
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertCXXMethodHeader(const CXXMethodDecl* stmt, OutputFormatHelper& initOutputFormatHelper)
+///! The number of characters the small buffer of \p string holds, for characters of \p charSize bytes. libc++ keeps
+///! them in the three pointers of the long representation, libstdc++ and the MSVC STL in a buffer of 16 bytes. Each
+///! reserves one character for the terminating null.
+static uint64_t GetSmallStringCapacity(const CXXRecordDecl& string, uint64_t charSize)
 {
-    LAMBDA_SCOPE_HELPER(CXXMethodDecl);
-    CXXConstructorDecl* cxxInheritedCtorDecl{nullptr};
+    // libc++ lives in the inline namespace std::__1.
+    if(const auto* ns = dyn_cast_or_null<NamespaceDecl>(string.getDeclContext());
+       ns and ns->isInline() and ("__1"sv == ns->getName())) {
+        const auto& ctx = GetGlobalAST();
+        const auto  longSize{3 * ctx.getTypeSizeInChars(ctx.VoidPtrTy).getQuantity()};
 
-    // Traverse the ctor inline init statements first to find a potential CXXInheritedCtorInitExpr. This carries the
-    // name and the type. The CXXMethodDecl above knows only the type.
-    if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(stmt)) {
-        CodeGeneratorVariant codeGenerator{initOutputFormatHelper, mLambdaStack, mProcessingPrimaryTemplate};
-        codeGenerator->mCurrentVarDeclPos         = mCurrentVarDeclPos;
-        codeGenerator->mCurrentFieldPos           = mCurrentFieldPos;
-        codeGenerator->mCurrentCallExprPos        = mCurrentCallExprPos;
-        codeGenerator->mOutputFormatHelperOutside = &mOutputFormatHelper;
+        return std::max<uint64_t>((longSize - 1) / charSize, 2) - 1;
+    }
 
-        for(OnceTrue first{}; const auto* init : ctor->inits()) {
-            initOutputFormatHelper.AppendNewLine();
-            if(first) {
-                initOutputFormatHelper.Append(": "sv);
-            } else {
-                initOutputFormatHelper.Append(", "sv);
-            }
+    return (16 / charSize) - 1;
+}
+//-----------------------------------------------------------------------------
 
-            // in case of delegating or base initializer there is no member.
-#if 0
-            if(const auto* member = init->getMember()) {
-                initOutputFormatHelper.Append(member->getName());
-                codeGenerator->InsertCurlysIfRequired(init->getInit());
-            } else {
-                const auto* inlineInit = init->getInit();
-                bool        useCurlies{false};
+///! The allocation done by \p ctorExpr, if it constructs a standard container, a string, a \c std::function or a
+///! \c std::shared_ptr. A move only steals the memory of the source.
+static std::string GetAllocatingConstruction(const CXXConstructExpr& ctorExpr)
+{
+    static constexpr std::array containers{"vector"sv,
+                                           "deque"sv,
+                                           "list"sv,
+                                           "forward_list"sv,
+                                           "map"sv,
+                                           "multimap"sv,
+                                           "set"sv,
+                                           "multiset"sv,
+                                           "unordered_map"sv,
+                                           "unordered_multimap"sv,
+                                           "unordered_set"sv,
+                                           "unordered_multiset"sv};
 
-                if(const auto* cxxInheritedCtorInitExpr = dyn_cast_or_null<CXXInheritedCtorInitExpr>(inlineInit)) {
-                    cxxInheritedCtorDecl = cxxInheritedCtorInitExpr->getConstructor();
+    const auto* ctor   = ctorExpr.getConstructor();
+    const auto* record = ctor->getParent();
 
-                    // Insert the base class name only, if it is not a CXXContructorExpr and not a
-                    // CXXDependentScopeMemberExpr which already carry the type.
-                } else if(init->isBaseInitializer() and not isa<CXXConstructExpr>(inlineInit)) {
-                    initOutputFormatHelper.Append(GetUnqualifiedScopelessName(init->getBaseClass()));
-                    useCurlies = true;
-                }
+    if(not record->isInStdNamespace() or ctor->isMoveConstructor() or (nullptr == record->getIdentifier())) {
+        return {};
+    }
 
-                codeGenerator->WrapInCurliesIfNeeded(useCurlies, [&] { codeGenerator->InsertArg(inlineInit); });
-            }
-#else
-            const auto* inlineInit = init->getInit();
+    const std::string_view name{record->getName()};
+    const auto             type = GetName(ctorExpr.getType());
 
-            // in case of delegating or base initializer there is no member.
-            if(const auto* member = init->getMember()) {
-                initOutputFormatHelper.Append(member->getName());
+    // A default constructed container allocates with the first insertion.
+    if(is_contained(containers, name)) {
+        return StrCat(type, ValueOrDefault(ctor->isDefaultConstructor(), ", default constructed"sv));
 
-                if(isa<ParenListExpr>(inlineInit)) {
-                    codeGenerator->WrapInParens([&] { codeGenerator->InsertArg(inlineInit); });
-                } else {
-                    codeGenerator->InsertCurlysIfRequired(inlineInit);
-                }
+    } else if(ctor->isDefaultConstructor()) {
+        return {};
+    }
 
-            } else if(const auto* cxxInheritedCtorInitExpr = dyn_cast_or_null<CXXInheritedCtorInitExpr>(inlineInit)) {
-                cxxInheritedCtorDecl = cxxInheritedCtorInitExpr->getConstructor();
+    const auto* firstArg = (0 != ctorExpr.getNumArgs()) ? ctorExpr.getArg(0) : nullptr;
 
-                codeGenerator->InsertArg(inlineInit);
+    if("basic_string"sv == name) {
+        // A literal which fits the small buffer does not allocate.
+        if(const auto* literal = firstArg ? dyn_cast_or_null<StringLiteral>(firstArg->IgnoreImpCasts()) : nullptr) {
+            if(literal->getLength() <= GetSmallStringCapacity(*record, literal->getCharByteWidth())) {
+                return {};
+            }
 
-                // Insert the base class name only, if it is not a CXXContructorExpr and not a
-                // CXXDependentScopeMemberExpr which already carry the type.
-            } else if(init->isBaseInitializer() and not isa<CXXConstructExpr>(inlineInit)) {
-                initOutputFormatHelper.Append(GetUnqualifiedScopelessName(init->getBaseClass()));
+            return StrCat(type, " from a literal of "sv, literal->getLength(), " characters"sv);
+        }
 
-                const auto braceKind = isa<ParenListExpr>(inlineInit) ? BraceKind::Parens : BraceKind::Curlys;
+        return StrCat(type, " from a non-literal"sv);
 
-                codeGenerator->WrapInParensOrCurlys(braceKind, [&] { codeGenerator->InsertArg(inlineInit); });
-            } else {
-                codeGenerator->InsertArg(inlineInit);
-            }
-#endif
+    } else if(is{name}.any_of("function"sv, "shared_ptr"sv)) {
+        if(firstArg and firstArg->getType()->isNullPtrType()) {
+            return {};
+        }
+
+        // Another std::shared_ptr or std::weak_ptr shares its control block.
+        if(const auto* argRecord = firstArg ? firstArg->getType()->getAsCXXRecordDecl() : nullptr;
+           argRecord and argRecord->isInStdNamespace() and argRecord->getIdentifier() and
+           is{std::string_view{argRecord->getName()}}.any_of("shared_ptr"sv, "weak_ptr"sv)) {
+            return {};
         }
+
+        return type;
     }
 
-    InsertTemplateGuardBegin(stmt);
-    InsertFunctionNameWithReturnType(*stmt, cxxInheritedCtorDecl);
+    return {};
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertCXXMethodDecl(const CXXMethodDecl* stmt, SkipBody skipBody)
+///! Collects the sites of a function body which allocate dynamic memory, for \c --edu-show-allocations.
+class AllocationFinder
 {
-    OutputFormatHelper initOutputFormatHelper{};
-    initOutputFormatHelper.SetIndent(mOutputFormatHelper, OutputFormatHelper::SkipIndenting::Yes);
+public:
+    struct Site
+    {
+        const Stmt* stmt;
+        std::string what;
+        bool        inLoop;
+    };
 
-    const auto posBeforeFunc = mOutputFormatHelper.CurrentPos();
+    SmallVector<Site, 8> sites{};
 
-    InsertCXXMethodHeader(stmt, initOutputFormatHelper);
+    void Find(const Stmt* stmt)
+    {
+        if((nullptr == stmt) or isa<UnaryExprOrTypeTraitExpr, CXXNoexceptExpr>(stmt)) {
+            return;
 
-    if(not stmt->isUserProvided() or stmt->isExplicitlyDefaulted()) {
-        InsertTemplateGuardEnd(stmt);
-        return;
-    }
+        } else if(const auto* lambdaExpr = dyn_cast_or_null<LambdaExpr>(stmt)) {
+            for(const auto* init : lambdaExpr->capture_inits()) {
+                Find(init);
+            }
 
-    mOutputFormatHelper.Append(initOutputFormatHelper);
+            // Where the closure is called is unknown here.
+            BackupAndRestore _{mInLoop, false};
+            Find(lambdaExpr->getBody());
 
-    if(isa<CXXConversionDecl>(stmt)) {
-        if(stmt->getParent()->isLambda() and not stmt->doesThisDeclarationHaveABody()) {
-            mOutputFormatHelper.AppendNewLine();
-            WrapInCurlys([&]() {
-                mOutputFormatHelper.AppendNewLine();
-                mOutputFormatHelper.Append("  "sv, kwReturn, " "sv);
-                if(const auto* invoker = stmt->getParent()->getLambdaStaticInvoker()) {
-                    mOutputFormatHelper.AppendSemiNewLine(invoker->getName());
-                } else {
-                    mOutputFormatHelper.AppendSemiNewLine(kwOperator, "()"sv);
-                }
-            });
+            return;
+
+        } else if(const auto* forStmt = dyn_cast_or_null<ForStmt>(stmt)) {
+            Find(forStmt->getInit());
+
+            BackupAndRestore _{mInLoop, true};
+            Find(forStmt->getCond());
+            Find(forStmt->getInc());
+            Find(forStmt->getBody());
+
+            return;
+
+        } else if(const auto* rangeForStmt = dyn_cast_or_null<CXXForRangeStmt>(stmt)) {
+            Find(rangeForStmt->getInit());
+            Find(rangeForStmt->getRangeStmt());
+            Find(rangeForStmt->getBeginStmt());
+            Find(rangeForStmt->getEndStmt());
+
+            BackupAndRestore _{mInLoop, true};
+            Find(rangeForStmt->getCond());
+            Find(rangeForStmt->getInc());
+            Find(rangeForStmt->getLoopVarStmt());
+            Find(rangeForStmt->getBody());
+
+            return;
+
+        } else if(isa<WhileStmt, DoStmt>(stmt)) {
+            BackupAndRestore _{mInLoop, true};
+
+            for(const auto* child : stmt->children()) {
+                Find(child);
+            }
+
+            return;
         }
-    }
 
-    if((SkipBody::No == skipBody) and stmt->doesThisDeclarationHaveABody() and not stmt->isLambdaStaticInvoker()) {
-        InsertMethodBody(stmt, posBeforeFunc);
+        if(const auto* newExpr = dyn_cast_or_null<CXXNewExpr>(stmt)) {
+            // A placement new constructs in storage which exists already.
+            if(const auto* operatorNew = newExpr->getOperatorNew();
+               not(operatorNew and operatorNew->isReservedGlobalPlacementOperator())) {
+                Add(*stmt,
+                    StrCat("new "sv,
+                           GetName(newExpr->getAllocatedType()),
+                           ValueOrDefault(newExpr->isArray(), "[]"sv)));
+            }
 
-    } else if(not InsertLambdaStaticInvoker(stmt) or (SkipBody::Yes == skipBody)) {
-        mOutputFormatHelper.AppendSemiNewLine();
+        } else if(const auto* callExpr = dyn_cast_or_null<CallExpr>(stmt)) {
+            if(const auto* callee = callExpr->getDirectCallee()) {
+                Add(*stmt, GetAllocatingCall(*callee));
+            }
+
+        } else if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(stmt)) {
+            Add(*stmt, GetAllocatingConstruction(*ctorExpr));
+        }
+
+        for(const auto* child : stmt->children()) {
+            Find(child);
+        }
     }
 
-    InsertTemplateGuardEnd(stmt);
+private:
+    bool mInLoop{};
 
-    if(SkipBody::No == skipBody) {
-        mOutputFormatHelper.AppendNewLine();
+    void Add(const Stmt& stmt, std::string&& what)
+    {
+        if(not what.empty()) {
+            sites.push_back({&stmt, std::move(what), mInLoop});
+        }
     }
-}
+};
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const CXXMethodDecl* stmt)
+std::string EmitAllocationReport()
 {
-    // As per [special]/1: "Programs shall not define implicitly-declared special member functions." hide special
-    // members which are not used and with that not fully evaluated. This also hopefully removes confusion about the
-    // noexcept, which is not evaluated, if the special member is not used.
-    RETURN_IF(not GetInsightsOptions().UseShow2C and not stmt->hasBody() and not stmt->isUserProvided() and
-              not stmt->isExplicitlyDefaulted() and not stmt->isDeleted());
+    std::string sites{};
 
-    InsertCXXMethodDecl(stmt, SkipBody::No);
-}
-//-----------------------------------------------------------------------------
+    for(const auto* function : gAllocationFunctions) {
+        AllocationFinder finder{};
 
-void CodeGenerator::InsertArg(const EnumDecl* stmt)
-{
-    mOutputFormatHelper.Append(kwEnumSpace);
+        // A constructor initializes its bases and members before the body.
+        if(const auto* ctor = dyn_cast_or_null<CXXConstructorDecl>(function)) {
+            for(const auto* init : ctor->inits()) {
+                finder.Find(init->getInit());
+            }
+        }
 
-    if(stmt->isScoped()) {
-        if(stmt->isScopedUsingClassTag()) {
-            mOutputFormatHelper.Append(kwClassSpace);
-        } else {
-            mOutputFormatHelper.Append(kwStructSpace);
+        finder.Find(function->getBody());
+
+        if(finder.sites.empty()) {
+            continue;
         }
-    }
 
-    mOutputFormatHelper.Append(stmt->getName());
+        const auto& sm = GetSM(*function);
+        sites.append(StrCat("   "sv, GetSignature(*function), ":\n"sv));
 
-    if(stmt->isFixed()) {
-        mOutputFormatHelper.Append(" : "sv, GetName(stmt->getIntegerType()));
+        for(const auto& [stmt, what, inLoop] : finder.sites) {
+            sites.append(StrCat("     line "sv,
+                                sm.getSpellingLineNumber(stmt->getBeginLoc()),
+                                ": "sv,
+                                what,
+                                ValueOrDefault(inLoop, ", in a loop"sv),
+                                "\n"sv));
+        }
     }
 
-    mOutputFormatHelper.AppendNewLine();
+    gAllocationFunctions.clear();
 
-    WrapInCurlys(
-        [&]() {
-            mOutputFormatHelper.IncreaseIndent();
-            mOutputFormatHelper.AppendNewLine();
-            OnceFalse needsComma{};
+    if(sites.empty()) {
+        return {};
+    }
 
-            ForEachArg(stmt->enumerators(), [&](const auto* value) {
-                if(needsComma) {
-                    mOutputFormatHelper.AppendNewLine();
-                }
+    return StrCat("\n/* Allocation sites:\n"sv, sites, "*/\n"sv);
+}
+//-----------------------------------------------------------------------------
 
-                InsertArg(value);
-            });
+void ClearTranslationUnitRegistries()
+{
+    // The registries refer to nodes of the ASTContext and the scratch arena of the translation unit which ends now.
+    gVtables = {};
+    globalVarCtors.clear();
+    globalVarDtors.clear();
+    gStaticInitVars.clear();
+    gGuardedStatics.clear();
+    gExceptionCostDecls.clear();
+    gAllocationFunctions.clear();
+    gInstantiationStats.clear();
+    gCopiesPerFunction.clear();
+    gLocalUses.clear();
+    gLayoutSavings.clear();
+    gLambdaCaptures.clear();
+}
+//-----------------------------------------------------------------------------
 
-            InsertArg(stmt->getBody());
+///! Whether the layout of \p record is shown, either for every record or with \c --edu-show-lambda-layout only for
+///! closure types.
+static bool ShowLayout(const RecordDecl& record)
+{
+    if(GetInsightsOptions().UseShowPadding) {
+        return true;
+    }
 
-            mOutputFormatHelper.DecreaseIndent();
-            mOutputFormatHelper.AppendNewLine();
-        },
-        AddSpaceAtTheEnd::No);
+    const auto* cxxRecordDecl = dyn_cast_or_null<CXXRecordDecl>(&record);
 
-    mOutputFormatHelper.AppendSemiNewLine();
-    mOutputFormatHelper.AppendNewLine();
+    return GetInsightsOptions().UseShowLambdaLayout and cxxRecordDecl and cxxRecordDecl->isLambda();
 }
 //-----------------------------------------------------------------------------
 
-void CodeGenerator::InsertArg(const EnumConstantDecl* stmt)
+///! Whether a closure of \p record fits the inline buffer of a type-eraser like \c std::function.
+static std::string GetInlineBufferFit(const CXXRecordDecl& record, const ASTRecordLayout& recordLayout)
 {
-    mOutputFormatHelper.Append(stmt->getName());
+    const uint64_t bufferSize = GetInsightsOptions().LambdaInlineBufferSize;
 
-    InsertAttributes(stmt);
+    if((0 == bufferSize) or not record.isLambda()) {
+        return {};
+    }
 
-    if(const auto* initExpr = stmt->getInitExpr()) {
-        mOutputFormatHelper.Append(hlpAssing);
+    if(static_cast<uint64_t>(recordLayout.getSize().getQuantity()) > bufferSize) {
+        return StrCat(", exceeds an inline buffer of "sv, bufferSize, " bytes, a type-eraser allocates"sv);
+    }
 
-        InsertArg(initExpr);
+    std::string ret{StrCat(", fits an inline buffer of "sv, bufferSize, " bytes"sv)};
+
+    // libstdc++'s std::function keeps only location invariant, i.e. trivially copyable, callables in its buffer.
+    if(not record.isTriviallyCopyable()) {
+        ret.append(", not trivially copyable, std::function of libstdc++ allocates anyway"sv);
     }
-}
-//-----------------------------------------------------------------------------
 
-static auto& GetRecordLayout(const RecordDecl* recordDecl)
-{
-    return GetGlobalAST().getASTRecordLayout(recordDecl);
+    return ret;
 }
 //-----------------------------------------------------------------------------
 
@@ -3430,13 +6186,33 @@ auto GetSpaces(std::string::size_type offset)
 }
 //-----------------------------------------------------------------------------
 
+void CodeGenerator::InsertCachelineBoundaries(const FieldDecl& field)
+{
+    const auto& fields        = GetRecordLayoutSummary(field.getParent()).fields;
+    const auto  idx           = field.getFieldIndex();
+    const auto  cachelineSize = GetInsightsOptions().CachelineSize;
+
+    // The boundaries between the previous field and this one. A boundary inside the previous field shows up here as
+    // well, the previous field is marked as straddling.
+    const uint64_t prevOffset = idx ? fields[idx - 1].offset : 0;
+
+    for(auto line = (prevOffset / cachelineSize) + 1; line <= (fields[idx].offset / cachelineSize); ++line) {
+        mOutputFormatHelper.AppendCommentNewLine("cache line "sv, line, ", offset: "sv, line * cachelineSize);
+    }
+}
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::InsertArg(const FieldDecl* stmt)
 {
     LAMBDA_SCOPE_HELPER(Decltype);
     P0315Visitor dt{*this};
 
     auto type = GetType(stmt->getType());
-    dt.TraverseType(type);
+    dt.TraverseTypeIfLambda(type);
+
+    if(GetInsightsOptions().UseShowCachelines) {
+        InsertCachelineBoundaries(*stmt);
+    }
 
     const auto initialSize{mOutputFormatHelper.size()};
     InsertAttributes(stmt->attrs());
@@ -3473,41 +6249,32 @@ void CodeGenerator::InsertArg(const FieldDecl* stmt)
 
     mOutputFormatHelper.Append(';');
 
-    if(GetInsightsOptions().UseShowPadding) {
-        const auto* fieldClass   = stmt->getParent();
-        const auto& recordLayout = GetRecordLayout(fieldClass);
-        auto        effectiveFieldSize{GetGlobalAST().getTypeInfoInChars(type).Width.getQuantity()};
-        auto        getFieldOffsetInBytes = [&recordLayout](const FieldDecl* field) {
-            return recordLayout.getFieldOffset(field->getFieldIndex()) / 8;  // this is in bits
-        };
-        auto       fieldOffset = getFieldOffsetInBytes(stmt);
-        const auto offset      = mOutputFormatHelper.size() - initialSize;
+    if(ShowLayout(*stmt->getParent())) {
+        const auto& [fieldOffset, effectiveFieldSize, padding, falseSharingWith, wastesStorage] =
+            GetRecordLayoutSummary(stmt->getParent()).fields[stmt->getFieldIndex()];
+        const auto offset = mOutputFormatHelper.size() - initialSize;
 
         mOutputFormatHelper.Append(GetSpaces(offset), "  /* offset: "sv, fieldOffset, ", size: "sv, effectiveFieldSize);
 
-        // - get next field
-        // - if this fields offset + size is equal to the next fields offset we are good,
-        // - if not we insert padding bytes
-        // - in case there is no next field this is the last field, check this field's offset + size against the
-        // records
-        //   size. If unequal padding is needed
-
-        const auto expectedOffset = fieldOffset + effectiveFieldSize;
-        const auto nextOffset     = [&]() -> uint64_t {
-            // find previous field
-            if(const auto next = stmt->getFieldIndex() + 1; recordLayout.getFieldCount() > next) {
-                // We are in bounds, means we expect to get back a valid iterator
-                const auto* field = *std::next(fieldClass->fields().begin(), next);
-
-                return getFieldOffsetInBytes(field);
+        if(GetInsightsOptions().UseShowCachelines) {
+            const auto cachelineSize = GetInsightsOptions().CachelineSize;
+
+            if(effectiveFieldSize and
+               ((fieldOffset / cachelineSize) != ((fieldOffset + effectiveFieldSize - 1) / cachelineSize))) {
+                mOutputFormatHelper.Append(", straddles a cache line"sv);
             }
 
-            // no field found means we are the last field
-            return recordLayout.getSize().getQuantity();
-        }();
+            if(falseSharingWith) {
+                mOutputFormatHelper.Append(", false sharing with "sv, GetName(*falseSharingWith));
+            }
+        }
+
+        if(wastesStorage) {
+            mOutputFormatHelper.Append(", empty, [[no_unique_address]] lets it overlap"sv);
+        }
 
-        if(expectedOffset < nextOffset) {
-            const auto padding = nextOffset - expectedOffset;
+        // Padding is needed if this field does not end where the next field, or for the last field the record, starts.
+        if(padding) {
             mOutputFormatHelper.AppendNewLine();
             std::string s = StrCat("char "sv, BuildInternalVarName("padding"sv), "["sv, padding, "];"sv);
             mOutputFormatHelper.Append(s, GetSpaces(s.length()), "                size: ", padding);
@@ -3741,16 +6508,37 @@ void CodeGenerator::InsertTemplate(const FunctionTemplateDecl* stmt, bool withSp
 
     RETURN_IF(not withSpec);
 
+    SpecializationsState state{};
+
     for(const auto* spec : stmt->specializations()) {
         // For specializations we will see them later
         if(spec->getPreviousDecl()) {
             continue;
         }
 
+        const auto* args = spec->getTemplateSpecializationArgs();
+
+        if(args and SkipSpecialization(*stmt, *spec, args->asArray(), state)) {
+            continue;
+        }
+
         mOutputFormatHelper.AppendNewLine();
-        InsertArg(spec);
-        mOutputFormatHelper.AppendNewLine();
+
+        bool insertedCode{true};
+
+        if(args) {
+            insertedCode = InsertSpecialization(*stmt, *spec, args->asArray(), state);
+        } else {
+            InsertArg(spec);
+        }
+
+        // A collapsed specialization is only a comment line, it needs no separator after it.
+        if(insertedCode) {
+            mOutputFormatHelper.AppendNewLine();
+        }
     }
+
+    InsertSkippedSpecializations(*stmt, state);
 }
 //-----------------------------------------------------------------------------
 
@@ -3940,10 +6728,26 @@ void CodeGenerator::InsertArg(const CXXRecordDecl* stmt)
         });
     }
 
-    if(GetInsightsOptions().UseShowPadding) {
+    if(ShowLayout(*stmt)) {
         const auto& recordLayout = GetRecordLayout(stmt);
-        mOutputFormatHelper.AppendNewLine(
-            "  /* size: "sv, recordLayout.getSize(), ", align: "sv, recordLayout.getAlignment(), " */"sv);
+        mOutputFormatHelper.Append("  /* size: "sv, recordLayout.getSize(), ", align: "sv, recordLayout.getAlignment());
+
+        if(GetInsightsOptions().UseShowCachelines) {
+            const uint64_t cachelineSize = GetInsightsOptions().CachelineSize;
+            const uint64_t size          = recordLayout.getSize().getQuantity();
+
+            mOutputFormatHelper.Append(", cache lines: "sv, (size + cachelineSize - 1) / cachelineSize);
+        }
+
+        if(GetInsightsOptions().UseShowLambdaLayout) {
+            mOutputFormatHelper.Append(GetInlineBufferFit(*stmt, recordLayout));
+        }
+
+        if(const auto reclaimable = GetRecordLayoutSummary(stmt).reclaimable) {
+            mOutputFormatHelper.Append(", empty members and bases waste: "sv, reclaimable);
+        }
+
+        mOutputFormatHelper.AppendNewLine(" */"sv);
 
     } else {
         mOutputFormatHelper.AppendNewLine();
@@ -3951,16 +6755,21 @@ void CodeGenerator::InsertArg(const CXXRecordDecl* stmt)
 
     mOutputFormatHelper.OpenScope();
 
-    if(GetInsightsOptions().UseShowPadding) {
-        for(size_t offset{}; const auto& base : stmt->bases()) {
-            const auto& baseRecordLayout = GetRecordLayout(base.getType()->getAsRecordDecl());
-            const auto  baseVar          = StrCat("/* base ("sv, GetName(base.getType()), ")"sv);
-            const auto  size             = baseRecordLayout.getSize().getQuantity();
+    if(ShowLayout(*stmt)) {
+        const auto& bases = GetRecordLayoutSummary(stmt).bases;
 
-            mOutputFormatHelper.AppendNewLine(
-                baseVar, GetSpaces(baseVar.size()), "     offset: "sv, offset, ", size: "sv, size, " */"sv);
+        for(size_t idx{}; const auto& base : stmt->bases()) {
+            const auto  baseVar                 = StrCat("/* base ("sv, GetName(base.getType()), ")"sv);
+            const auto& [offset, size, blocked] = bases[idx++];
 
-            offset += size;
+            mOutputFormatHelper.AppendNewLine(baseVar,
+                                              GetSpaces(baseVar.size()),
+                                              "     offset: "sv,
+                                              offset,
+                                              ", size: "sv,
+                                              size,
+                                              ValueOrDefault(blocked, ", empty base optimization blocked"sv),
+                                              " */"sv);
         }
     }
 
@@ -4158,16 +6967,17 @@ void CodeGenerator::InsertArg(const CXXRecordDecl* stmt)
                     ctorArguments.append(name);
                 }
 
+                if(GetInsightsOptions().UseShowCopies and not isThis) {
+                    ctorArguments.append(GetCaptureCopyAnnotation(*stmt, expr));
+                }
+
                 mOutputFormatHelper.Append(GetTypeNameAsParameter(fieldDeclType, StrCat("_"sv, name)));
             };
 
-        llvm::DenseMap<const ValueDecl*, FieldDecl*> captures{};
-        FieldDecl*                                   thisCapture{};
-
-        stmt->getCaptureFields(captures, thisCapture);
+        const auto& captureIndex = GetLambdaCaptureIndex(*stmt);
 
         // Check if it captures this
-        if(thisCapture) {
+        if(const auto* thisCapture = captureIndex.thisCapture) {
             const auto* captureInit = mLambdaExpr->capture_init_begin();
 
             addToInits(kwThis, thisCapture, true, *captureInit, false);
@@ -4182,7 +6992,7 @@ void CodeGenerator::InsertArg(const CXXRecordDecl* stmt)
             }
 
             const auto* capturedVar = c.getCapturedVar();
-            if(const auto* value = captures[capturedVar]) {
+            if(const auto* value = captureIndex.captures.lookup(capturedVar)) {
                 // Since C++20 lambdas can capture structured bindings
                 if(const auto* bindingDecl = dyn_cast_or_null<BindingDecl>(capturedVar)) {
                     const auto* decompositionDecl = cast<DecompositionDecl>(bindingDecl->getDecomposedDecl());
@@ -4251,6 +7061,20 @@ void CodeGenerator::InsertArg(const CXXRecordDecl* stmt)
     }
 
     mOutputFormatHelper.AppendSemiNewLine();
+
+    if(GetInsightsOptions().UseSuggestLayout) {
+        InsertLayoutSuggestion(*stmt);
+    }
+
+    if(GetInsightsOptions().UseShowTypeTraits) {
+        InsertTypeTraits(*stmt);
+    }
+
+    if(GetInsightsOptions().UseShowExceptionCosts and stmt->isThisDeclarationADefinition() and not stmt->isLambda() and
+       not stmt->isDependentContext() and not stmt->isInvalidDecl()) {
+        gExceptionCostDecls.insert(stmt);
+    }
+
     mOutputFormatHelper.AppendNewLine();
 }
 //-----------------------------------------------------------------------------
@@ -4281,6 +7105,112 @@ void CodeGenerator::InsertArg(const SizeOfPackExpr* stmt)
 }
 //-----------------------------------------------------------------------------
 
+///! Check whether a return statement in \p stmt returns something else than \p var.
+static bool ReturnsOtherObject(const Stmt* stmt, const VarDecl& var)
+{
+    // A return statement in a lambda belongs to the lambda.
+    if((nullptr == stmt) or isa<LambdaExpr>(stmt)) {
+        return false;
+    }
+
+    if(const auto* returnStmt = dyn_cast_or_null<ReturnStmt>(stmt)) {
+        return returnStmt->getNRVOCandidate() != &var;
+    }
+
+    return ranges::any_of(stmt->children(), [&](const Stmt* child) { return ReturnsOtherObject(child, var); });
+}
+//-----------------------------------------------------------------------------
+
+///! Why the named return value optimization does not apply to \p candidate.
+static std::string_view GetNRVOBlocker(const VarDecl& candidate)
+{
+    if(isa<ParmVarDecl>(candidate)) {
+        return "a parameter is not constructed in the return slot"sv;
+    }
+
+    const auto* function = dyn_cast_or_null<FunctionDecl>(candidate.getParentFunctionOrMethod());
+
+    if(function and not GetGlobalAST().hasSameUnqualifiedType(candidate.getType(), function->getReturnType())) {
+        return "the type differs from the return type"sv;
+
+    } else if(function and ReturnsOtherObject(function->getBody(), candidate)) {
+        return "the function returns different objects"sv;
+    }
+
+    return "not applied by the compiler"sv;
+}
+//-----------------------------------------------------------------------------
+
+///! The local variable or parameter \p ctorExpr constructs the returned object from, if the return treats it as an
+///! rvalue. \c ReturnStmt::getNRVOCandidate knows only the candidates for copy elision, which excludes parameters and
+///! variables of another type than the return type. All of them are moved implicitly since C++20.
+static const VarDecl* GetImplicitMoveCandidate(const CXXConstructExpr* ctorExpr)
+{
+    if((nullptr == ctorExpr) or (0 == ctorExpr->getNumArgs())) {
+        return nullptr;
+    }
+
+    const auto* arg     = ctorExpr->getArg(0);
+    const auto* declRef = dyn_cast_or_null<DeclRefExpr>(arg->IgnoreImplicit());
+    const auto* var     = declRef ? dyn_cast_or_null<VarDecl>(declRef->getDecl()) : nullptr;
+
+    if((nullptr == var) or not var->hasLocalStorage() or var->getType()->isReferenceType()) {
+        return nullptr;
+    }
+
+    // The name is cast to an xvalue. Without a usable move constructor the copy constructor gets the xvalue.
+    if(arg->isXValue() or ctorExpr->getConstructor()->isMoveConstructor()) {
+        return var;
+    }
+
+    return nullptr;
+}
+//-----------------------------------------------------------------------------
+
+///! What the compiler does to get the returned object of class type into the return slot.
+static std::string GetReturnElision(const ReturnStmt& stmt)
+{
+    const auto* retVal = stmt.getRetValue();
+
+    if((nullptr == retVal) or retVal->isTypeDependent() or not retVal->getType()->isRecordType()) {
+        return {};
+    }
+
+    if(const auto* candidate = stmt.getNRVOCandidate(); candidate and candidate->isNRVOVariable()) {
+        return "NRVO";
+    }
+
+    const auto* expr     = retVal->IgnoreImplicit();
+    const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(expr);
+
+    if(const auto* candidate = GetImplicitMoveCandidate(ctorExpr)) {
+        // Without a usable move constructor overload resolution falls back to the copy constructor.
+        const bool copies = ctorExpr->getConstructor()->isCopyConstructor();
+
+        return StrCat(ValueOr(copies, "copy"sv, "implicit move"sv), ", no NRVO: "sv, GetNRVOBlocker(*candidate));
+    }
+
+    if(ctorExpr and ctorExpr->getConstructor()->isCopyOrMoveConstructor()) {
+        if(not ctorExpr->getConstructor()->isMoveConstructor()) {
+            return "copy";
+        }
+
+        if(const auto* callExpr = dyn_cast_or_null<CallExpr>(ctorExpr->getArg(0)->IgnoreImplicit());
+           callExpr and callExpr->isCallToStdMove()) {
+            return "move, std::move prevents NRVO";
+        }
+
+        return "move";
+    }
+
+    if(expr->isPRValue()) {
+        return "guaranteed copy elision";
+    }
+
+    return {};
+}
+//-----------------------------------------------------------------------------
+
 void CodeGenerator::InsertArg(const ReturnStmt* stmt)
 {
     LAMBDA_SCOPE_HELPER(ReturnStmt);
@@ -4298,12 +7228,24 @@ void CodeGenerator::InsertArg(const ReturnStmt* stmt)
             if(not temporaryFinder.Found()) {
                 if(const auto* nrvoVD = stmt->getNRVOCandidate()) {
                     mOutputFormatHelper.Append(GetName(*nrvoVD));
+
+                    // Without NRVO the candidate is still copied into the return slot.
+                    if(const auto* ctorExpr = dyn_cast_or_null<CXXConstructExpr>(retVal->IgnoreImplicit());
+                       ctorExpr and GetInsightsOptions().UseShowCopies and not nrvoVD->isNRVOVariable()) {
+                        InsertCopyAnnotation(*ctorExpr);
+                    }
                 } else {
                     InsertArg(retVal);
                 }
             } else {
                 mOutputFormatHelper.Append(temporaryFinder.Name());
             }
+
+            if(GetInsightsOptions().UseShowCopyElision) {
+                if(const auto elision = GetReturnElision(*stmt); not elision.empty()) {
+                    mOutputFormatHelper.Append(" /* "sv, elision, " */"sv);
+                }
+            }
         }
     }
 
@@ -4676,6 +7618,10 @@ void CodeGenerator::HandleLocalStaticNonTrivialClass(const VarDecl* stmt)
 {
     EnableGlobalInsert(GlobalInserts::HeaderNew);
 
+    if(GetInsightsOptions().UseShowStaticGuards) {
+        gGuardedStatics.insert(stmt);
+    }
+
     const auto& ctx = GetGlobalAST();
 
     auto&      langOpts{GetLangOpts(*stmt)};
@@ -11,6 +11,10 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/simple_ilist.h"
+#include "llvm/Support/Allocator.h"
 
 #include <optional>
 
@@ -27,9 +31,12 @@ namespace clang::insights {
 void PushVtableEntry(const CXXRecordDecl*, const CXXRecordDecl*, VarDecl* decl);
 int  GetGlobalVtablePos(const CXXRecordDecl*, const CXXRecordDecl*);
 
+/// \brief A comment in the generated code.
+///
+/// The comment text is not owned. \ref asthelpers::Comment stores it in the \ref ScratchArena together with the node.
 class CppInsightsCommentStmt : public Stmt
 {
-    std::string mComment{};
+    std::string_view mComment{};
 
 public:
     CppInsightsCommentStmt(std::string_view comment)
@@ -54,29 +61,39 @@ public:
     }
 };
 
-struct LifetimeEntry
+/// \brief A single object tracked by the \ref LifetimeTracker.
+///
+/// The entries are linked intrusively into the list of the scope they belong to. This allows inserting a life-time
+/// extended object right after its extending object in O(1).
+struct LifetimeEntry : llvm::ilist_node<LifetimeEntry>
+{
+    const VarDecl* item{};
+    size_t         scope{};  ///! Index of the owning scope in the scope stack.
+};
+
+/// \brief A scope of the \ref LifetimeTracker with the objects living in it in order of their construction.
+struct LifetimeScope
 {
     STRONG_BOOL(FuncStart);
 
-    const VarDecl* item{};
-    FuncStart      funcStart{FuncStart::No};
-    int            scope{};
+    llvm::simple_ilist<LifetimeEntry> objects{};
+    FuncStart                         funcStart{FuncStart::No};
 };
 
 class LifetimeTracker
 {
-    inline static int scopeCounter{};
+    SmallVector<LifetimeScope, 10>                 scopes{};
+    llvm::DenseMap<const VarDecl*, LifetimeEntry*> entries{};  ///! Maps a tracked object to its scope entry.
+    llvm::SpecificBumpPtrAllocator<LifetimeEntry>  allocator{};
+    llvm::simple_ilist<LifetimeEntry>              freeEntries{};  ///! Entries of already ended scopes for reuse.
 
-    SmallVector<LifetimeEntry, 10> objects{};
-
-    void InsertDtorCall(const VarDecl* decl, OutputFormatHelper& ofm);
+    LifetimeEntry* NewEntry(const VarDecl* decl, size_t scope);
+    void           InsertDtorCall(const VarDecl* decl, OutputFormatHelper& ofm);
 
 public:
     void Add(const VarDecl* decl);
     void AddExtended(const VarDecl* decl, const ValueDecl* extending);
 
-    LifetimeEntry& top() { return objects.back(); }
-
     void removeTop();
     void StartScope(bool funcStart);
     bool Return(OutputFormatHelper& ofm);
@@ -372,6 +389,54 @@ protected:
 
     void InsertInstantiationPoint(const SourceManager& sm, const SourceLocation& instLoc, std::string_view text = {});
 
+    /// \brief Insert a marker for each cache-line boundary between the previous field and \p field.
+    void InsertCachelineBoundaries(const FieldDecl& field);
+
+    /// \brief Insert the field order of \p record with the least padding as a comment, if it is smaller.
+    void InsertLayoutSuggestion(const CXXRecordDecl& record);
+
+    /// \brief Insert the type traits of \p record which drive container performance and what breaks them.
+    void InsertTypeTraits(const CXXRecordDecl& record);
+
+    /// \brief Annotate a non-trivial copy construction from an expiring value.
+    void InsertCopyAnnotation(const CXXConstructExpr& stmt);
+
+    /// \brief Annotate a non-trivial copy assignment from an expiring value.
+    void InsertCopyAnnotation(const CXXOperatorCallExpr& stmt);
+
+    ///! The state of inserting the specializations of a single primary template.
+    struct SpecializationsState
+    {
+        ///! Maps the normalized code of a specialization to the name of the first specialization with this code.
+        llvm::StringMap<std::string> seenCode{};
+        ///! Name and point of instantiation of the specializations beyond \c --max-specializations.
+        SmallVector<std::pair<std::string, SourceLocation>, 8> notShown{};
+        unsigned                                               shown{};
+    };
+
+    /// \brief Insert a specialization of \p primary.
+    ///
+    /// With \c --collapse-identical-specializations a specialization whose code differs from an earlier one only in the
+    /// template arguments is replaced by a comment referring to the earlier one.
+    ///
+    /// \returns Whether the code of \p spec was inserted, rather than the comment.
+    template<typename T>
+    bool InsertSpecialization(const TemplateDecl&        primary,
+                              const T&                   spec,
+                              ArrayRef<TemplateArgument> args,
+                              SpecializationsState&      state);
+
+    /// \brief Check whether \p spec is beyond \c --max-specializations and remember it for the summary if so.
+    template<typename T>
+    bool SkipSpecialization(const TemplateDecl&        primary,
+                            const T&                   spec,
+                            ArrayRef<TemplateArgument> args,
+                            SpecializationsState&      state);
+
+    /// \brief List the specializations skipped due to \c --max-specializations together with their point of
+    /// instantiation.
+    void InsertSkippedSpecializations(const TemplateDecl& primary, const SpecializationsState& state);
+
     STRONG_BOOL(AddNewLineAfter);
 
     void WrapInCompoundIfNeeded(const Stmt* stmt, const AddNewLineAfter addNewLineAfter);
@@ -452,6 +517,7 @@ protected:
                                                   //!< potential std::initializer_list expansion must be inserted.
     std::optional<size_t> mCurrentFieldPos{};     //!< The position in mOutputFormatHelper in a class where where a
                                                   //!< potential std::initializer_list expansion must be inserted.
+    const VarDecl* mRangeForLoopVar{};  //!< The loop variable of the range-based for-loop currently inserted.
     OutputFormatHelper* mOutputFormatHelperOutside{
         nullptr};                        //!< Helper output buffer for std::initializer_list expansion.
     bool mRequiresImplicitReturnZero{};  //!< Track whether this is a function with an imlpicit return 0.
@@ -523,6 +589,16 @@ struct CoroutineASTData
     MemberExpr*                     mSuspendIndexAccess{};
     bool                            mDoInsertInDtor{};
     std::vector<const CXXThisExpr*> mThisExprs{};
+
+    ///! Parameters and locals which got a field in the frame.
+    llvm::DenseMap<const FieldDecl*, const VarDecl*> mHoistedVars{};
+    ///! The suspend points of the coroutine body in source order, only collected for \c -edu-show-coroutine-frame.
+    SmallVector<SourceLocation, 8> mSuspendPoints{};
+    ///! The range [first, last) of \c mSuspendPoints a local is alive across.
+    llvm::DenseMap<const VarDecl*, std::pair<size_t, size_t>> mLiveAcross{};
+    ///! Source positions [begin, end] between which a local or an awaiter is alive.
+    llvm::DenseMap<const VarDecl*, std::pair<uint64_t, uint64_t>>         mLocalLifetimes{};
+    llvm::DenseMap<const OpaqueValueExpr*, std::pair<uint64_t, uint64_t>> mAwaiterLifetimes{};
 };
 
 ///
@@ -598,6 +674,7 @@ private:
     QualType GetFramePointerType() const;
 
     std::string BuildResumeLabelName(int) const;
+    std::string BuildSlotSharingReport() const;
     FieldDecl*  AddField(std::string_view name, QualType type);
 
     void InsertArgWithNull(const Stmt* stmt);
@@ -6,6 +6,7 @@
  ****************************************************************************/
 
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <vector>
 #include "ASTHelpers.h"
@@ -41,6 +42,55 @@ QualType CoroutinesCodeGenerator::GetFramePointerType() const
 }
 //-----------------------------------------------------------------------------
 
+///! Explain for each parameter and local in the frame why it lives there.
+static std::string BuildHoistedVarsReport(const CoroutineASTData& astData)
+{
+    const auto& sm = GetGlobalAST().getSourceManager();
+    std::string ret{};
+
+    for(const auto* field : astData.mFrameType->fields()) {
+        const auto* varDecl = astData.mHoistedVars.lookup(field);
+
+        if(nullptr == varDecl) {
+            continue;
+        }
+
+        ret.append(StrCat("   "sv, GetName(*varDecl), ": "sv));
+
+        if(isa<ParmVarDecl>(varDecl)) {
+            ret.append("parameter, lives as long as the frame"sv);
+
+        } else if(const auto [first, last] = astData.mLiveAcross.lookup(varDecl); first != last) {
+            if(1 == (last - first)) {
+                ret.append("live across the suspend point at line "sv);
+            } else {
+                ret.append("live across the suspend points at lines "sv);
+            }
+
+            for(OnceFalse needsComma{};
+                const auto& loc : ArrayRef<SourceLocation>{astData.mSuspendPoints}.slice(first, last - first)) {
+                if(needsComma) {
+                    ret.append(", "sv);
+                }
+
+                ret.append(StrCat(sm.getSpellingLineNumber(loc)));
+            }
+
+        } else {
+            ret.append("not live across a suspend point, could stay on the stack"sv);
+        }
+
+        ret.append("\n"sv);
+    }
+
+    if(ret.empty()) {
+        return ret;
+    }
+
+    return StrCat("/* Hoisted into "sv, GetName(*astData.mFrameType), ":\n"sv, ret, "*/\n\n"sv);
+}
+//-----------------------------------------------------------------------------
+
 CoroutinesCodeGenerator::~CoroutinesCodeGenerator()
 {
     RETURN_IF(not(mASTData.mFrameType and mASTData.mDoInsertInDtor));
@@ -51,7 +101,17 @@ CoroutinesCodeGenerator::~CoroutinesCodeGenerator()
 
     // Using the "normal" CodeGenerator here as this is only about inserting the made up coroutine-frame.
     CodeGeneratorVariant codeGenerator{ofm};
-    codeGenerator->InsertArg(mASTData.mFrameType);
+
+    if(GetInsightsOptions().UseShowCoroutineFrame) {
+        // The frame layout is shown the same way as -edu-show-padding shows it for any other class.
+        BackupAndRestore _{GetInsightsOptionsRW().UseShowPadding, true};
+
+        codeGenerator->InsertArg(mASTData.mFrameType);
+        ofm.Append(BuildHoistedVarsReport(mASTData), BuildSlotSharingReport());
+
+    } else {
+        codeGenerator->InsertArg(mASTData.mFrameType);
+    }
 
     // Insert the made-up struct before the function declaration
     mOutputFormatHelper.InsertAt(mPosBeforeFunc, ofm);
@@ -255,6 +315,8 @@ public:
                 auto* me     = AccessMember(mASTData.mFrameAccessDeclRef, field);
                 auto* assign = Assign(me, field, varDecl->getInit());
 
+                mASTData.mHoistedVars[field] = varDecl;
+
                 mVarNamePrefix.insert(std::make_pair(varDecl, me));
 
                 Visit(varDecl->getInit());
@@ -380,6 +442,7 @@ public:
                         auto* field = AddField(mASTData, GetName(*varDecl), varDecl->getType());
                         auto* me    = AccessMember(mASTData.mFrameAccessDeclRef, field);
 
+                        mASTData.mHoistedVars[field] = varDecl;
                         mVarNamePrefix.insert(std::make_pair(const_cast<ParmVarDecl*>(varDecl), me));
                     }
                 }
@@ -412,6 +475,87 @@ public:
 };
 //-----------------------------------------------------------------------------
 
+///! Collect the suspend points in \p stmt in source order together with the end of the scope of each local.
+static void CollectSuspendPoints(const Stmt*                                                 stmt,
+                                 SourceLocation                                              scopeEnd,
+                                 SmallVectorImpl<const CoroutineSuspendExpr*>&               suspendPoints,
+                                 SmallVectorImpl<std::pair<const VarDecl*, SourceLocation>>& locals)
+{
+    RETURN_IF((nullptr == stmt) or isa<LambdaExpr>(stmt));
+
+    if(isa<CompoundStmt, ForStmt, CXXForRangeStmt, IfStmt, WhileStmt, SwitchStmt>(stmt)) {
+        scopeEnd = stmt->getEndLoc();
+    }
+
+    if(const auto* suspendExpr = dyn_cast_or_null<CoroutineSuspendExpr>(stmt)) {
+        suspendPoints.push_back(suspendExpr);
+        CollectSuspendPoints(suspendExpr->getOperand(), scopeEnd, suspendPoints, locals);
+
+        return;
+    }
+
+    if(const auto* declStmt = dyn_cast_or_null<DeclStmt>(stmt)) {
+        for(const auto* decl : declStmt->decls()) {
+            if(const auto* varDecl = dyn_cast_or_null<VarDecl>(decl); varDecl and not varDecl->isStaticLocal()) {
+                locals.emplace_back(varDecl, scopeEnd);
+            }
+        }
+    }
+
+    for(const auto* child : stmt->children()) {
+        CollectSuspendPoints(child, scopeEnd, suspendPoints, locals);
+    }
+}
+//-----------------------------------------------------------------------------
+
+///! A local is alive across all suspend points between its declaration and the end of its scope.
+static void ComputeLiveAcross(CoroutineASTData& astData, const CoroutineBodyStmt& stmt)
+{
+    const auto& sm = GetGlobalAST().getSourceManager();
+
+    SmallVector<const CoroutineSuspendExpr*, 8>               suspendExprs{};
+    SmallVector<std::pair<const VarDecl*, SourceLocation>, 8> locals{};
+    CollectSuspendPoints(stmt.getBody(), stmt.getEndLoc(), suspendExprs, locals);
+
+    // Positions in the source, shifted by one to leave room for the initial suspend.
+    auto position = [&](SourceLocation loc) -> uint64_t { return sm.getFileOffset(sm.getExpansionLoc(loc)) + 1; };
+
+    for(const auto* suspendExpr : suspendExprs) {
+        astData.mSuspendPoints.push_back(suspendExpr->getBeginLoc());
+        astData.mAwaiterLifetimes[suspendExpr->getOpaqueValue()] = {position(suspendExpr->getBeginLoc()),
+                                                                    position(suspendExpr->getEndLoc())};
+    }
+
+    // The awaiters of the initial and the final suspend are alive before respectively after everything else.
+    auto addImplicitSuspend = [&](const Stmt* suspendStmt, uint64_t pos) {
+        if(const auto* expr = dyn_cast_or_null<Expr>(suspendStmt)) {
+            if(const auto* suspendExpr = dyn_cast_or_null<CoroutineSuspendExpr>(expr->IgnoreImplicit())) {
+                astData.mAwaiterLifetimes[suspendExpr->getOpaqueValue()] = {pos, pos};
+            }
+        }
+    };
+
+    addImplicitSuspend(stmt.getInitSuspendStmt(), 0);
+    addImplicitSuspend(stmt.getFinalSuspendStmt(), std::numeric_limits<uint64_t>::max());
+
+    for(const auto& [varDecl, scopeEnd] : locals) {
+        astData.mLocalLifetimes[varDecl] = {position(varDecl->getEndLoc()), position(scopeEnd)};
+
+        auto isAlive = [&](SourceLocation loc) {
+            return sm.isBeforeInTranslationUnit(varDecl->getEndLoc(), loc) and
+                   sm.isBeforeInTranslationUnit(loc, scopeEnd);
+        };
+
+        const auto& suspendPoints = astData.mSuspendPoints;
+        const auto  firstAlive    = ranges::find_if(suspendPoints, isAlive);
+        const auto  first         = static_cast<size_t>(std::distance(suspendPoints.begin(), firstAlive));
+        const auto  count         = static_cast<size_t>(ranges::count_if(suspendPoints, isAlive));
+
+        astData.mLiveAcross[varDecl] = {first, first + count};
+    }
+}
+//-----------------------------------------------------------------------------
+
 void CoroutinesCodeGenerator::InsertCoroutine(const FunctionDecl& fd, const CoroutineBodyStmt* stmt)
 {
     mOutputFormatHelper.OpenScope();
@@ -497,6 +641,11 @@ void CoroutinesCodeGenerator::InsertCoroutine(const FunctionDecl& fd, const Coro
         InsertArg(ifStmt);
     }
 
+    // The transformation below rewrites the body, look at the original one first.
+    if(GetInsightsOptions().UseShowCoroutineFrame) {
+        ComputeLiveAcross(mASTData, *stmt);
+    }
+
     CoroutineASTTransformer{
         mASTData, mSuspendsCounter, const_cast<CoroutineBodyStmt*>(stmt), llvm::DenseMap<VarDecl*, MemberExpr*>{}};
 
@@ -886,6 +1035,122 @@ std::string CoroutinesCodeGenerator::BuildResumeLabelName(int index) const
 }
 //-----------------------------------------------------------------------------
 
+///! Find the fields of the frame which are never alive at the same time and could share their storage in a union.
+std::string CoroutinesCodeGenerator::BuildSlotSharingReport() const
+{
+    using Lifetime  = std::pair<uint64_t, uint64_t>;
+    const auto& ctx = GetGlobalAST();
+
+    // The awaiter fields are named after their opaque value.
+    llvm::StringMap<Lifetime> awaiterLifetimes{};
+    for(const auto& [opaqueValue, lifetime] : mASTData.mAwaiterLifetimes) {
+        if(const auto& s = FindValue(mOpaqueValues, opaqueValue->getSourceExpr())) {
+            awaiterLifetimes[std::string_view{s.value()}.substr(CORO_FRAME_ACCESS.size())] = lifetime;
+        }
+    }
+
+    SmallVector<std::pair<const FieldDecl*, Lifetime>, 8> candidates{};
+    SmallVector<const FieldDecl*, 16>                     fixedFields{};
+    SmallVector<const FieldDecl*, 4>                      stackFields{};
+
+    for(const auto* field : mASTData.mFrameType->fields()) {
+        const auto* varDecl = mASTData.mHoistedVars.lookup(field);
+
+        if(const auto liveAcross = mASTData.mLiveAcross.find(varDecl); liveAcross != mASTData.mLiveAcross.end()) {
+            if(liveAcross->second.first == liveAcross->second.second) {
+                stackFields.push_back(field);
+            } else {
+                candidates.emplace_back(field, mASTData.mLocalLifetimes.lookup(varDecl));
+            }
+
+        } else if(const auto awaiter = awaiterLifetimes.find(GetName(*field)); awaiterLifetimes.end() != awaiter) {
+            candidates.emplace_back(field, awaiter->second);
+
+        } else {
+            // Parameters, the promise and the other management fields are alive as long as the frame is.
+            fixedFields.push_back(field);
+        }
+    }
+
+    auto getTypeInfo = [&](const FieldDecl* field) {
+        const auto type = field->getType();
+
+        return ctx.getTypeInfoInChars(type->isReferenceType() ? ctx.VoidPtrTy : type);
+    };
+
+    struct Slot
+    {
+        SmallVector<const FieldDecl*, 4> fields{};
+        uint64_t                         end{};
+        CharUnits                        size{};
+        CharUnits                        align{CharUnits::One()};
+    };
+
+    // Greedy interval coloring: each field goes into the first slot whose last member is dead by then.
+    ranges::stable_sort(candidates, {}, [](const auto& candidate) { return candidate.second.first; });
+
+    SmallVector<Slot, 8> slots{};
+    for(const auto& [field, lifetime] : candidates) {
+        auto slot = ranges::find_if(slots, [&](const Slot& s) { return s.end < lifetime.first; });
+
+        if(slots.end() == slot) {
+            slot = &slots.emplace_back();
+        }
+
+        const auto typeInfo = getTypeInfo(field);
+
+        slot->fields.push_back(field);
+        slot->end   = lifetime.second;
+        slot->size  = std::max(slot->size, typeInfo.Width);
+        slot->align = std::max(slot->align, typeInfo.Align);
+    }
+
+    CharUnits offset{};
+    CharUnits maxAlign{CharUnits::One()};
+    auto      place = [&](CharUnits size, CharUnits align) {
+        offset   = offset.alignTo(align) + size;
+        maxAlign = std::max(maxAlign, align);
+    };
+
+    for(const auto* field : fixedFields) {
+        const auto typeInfo = getTypeInfo(field);
+        place(typeInfo.Width, typeInfo.Align);
+    }
+
+    std::string ret{StrCat("/* Storage sharing in "sv, GetName(*mASTData.mFrameType), ":\n"sv)};
+
+    for(const auto& slot : slots) {
+        place(slot.size, slot.align);
+
+        if(1 < slot.fields.size()) {
+            ret.append("   "sv);
+
+            for(OnceFalse needsComma{}; const auto* field : slot.fields) {
+                if(needsComma) {
+                    ret.append(", "sv);
+                }
+
+                ret.append(GetName(*field));
+            }
+
+            ret.append(StrCat(": never alive at the same time, could share "sv, slot.size, " bytes\n"sv));
+        }
+    }
+
+    for(const auto* field : stackFields) {
+        ret.append(StrCat("   "sv, GetName(*field), ": not live across a suspend point, needs no frame storage\n"sv));
+    }
+
+    ret.append(StrCat("   size: "sv,
+                      ctx.getASTRecordLayout(mASTData.mFrameType).getSize(),
+                      ", minimum size: "sv,
+                      offset.alignTo(maxAlign),
+                      "\n*/\n\n"sv));
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
 void CoroutinesCodeGenerator::InsertArg(const CoroutineSuspendExpr* stmt)
 {
     mOutputFormatHelper.AppendNewLine();
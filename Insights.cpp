@@ -22,6 +22,8 @@
 #include "CodeGenerator.h"
 #include "DPrint.h"
 #include "Insights.h"
+#include "InsightsHelpers.h"
+#include "InsightsScratchArena.h"
 #include "version.h"
 //-----------------------------------------------------------------------------
 
@@ -62,6 +64,15 @@ static llvm::cl::OptionCategory gInsightEduCategory(
                                              llvm::cl::location(gInsightsOptions.name),                                \
                                              llvm::cl::init(deflt),                                                    \
                                              llvm::cl::cat(category));
+
+#define INSIGHTS_OPT_VALUE(option, name, type, deflt, description, category)                                           \
+    static llvm::cl::opt<type, true> g##name(option,                                                                   \
+                                             llvm::cl::desc(std::string_view{description}),                            \
+                                             llvm::cl::value_desc("N"),                                                \
+                                             llvm::cl::NotHidden,                                                      \
+                                             llvm::cl::location(gInsightsOptions.name),                                \
+                                             llvm::cl::init(deflt),                                                    \
+                                             llvm::cl::cat(category));
 //-----------------------------------------------------------------------------
 
 #include "InsightsOptions.def"
@@ -83,6 +94,21 @@ const CompilerInstance&        GetGlobalCI()
 
 namespace clang::insights {
 std::string EmitGlobalVariableCtors();
+std::string EmitLayoutSuggestionSummary();
+std::string EmitCopySummary();
+std::string EmitStaticInitReport();
+std::string EmitStaticGuardReport();
+std::string EmitInstantiationStats();
+std::string EmitExceptionCostReport();
+std::string EmitAllocationReport();
+void        ClearTranslationUnitRegistries();
+
+static ScratchArena* gScratchArena{};
+
+ScratchArena& GetScratchArena()
+{
+    return *gScratchArena;
+}
 
 using GlobalInsertMap = std::pair<bool, std::string_view>;
 
@@ -161,10 +187,26 @@ public:
     }
 };
 
+static void PrintStats(const ASTContext& context, const ScratchArena& arena)
+{
+    auto& os = llvm::errs();
+
+    os << "C++ Insights statistics:\n";
+    os << "  Clang AST memory:       " << context.getASTAllocatedMemory() << " bytes\n";
+    os << "  Insights scratch arena: " << arena.BytesAllocated() << " bytes in " << arena.Nodes() << " nodes ("
+       << arena.TotalMemory() << " bytes reserved)\n";
+
+    const auto& p0315 = GetP0315Stats();
+    os << "  P0315 type checks:      " << p0315.lookups << " lookups, " << p0315.walks << " types walked, "
+       << p0315.traversals << " traversals\n";
+}
+//-----------------------------------------------------------------------------
+
 class CppInsightASTConsumer final : public ASTConsumer
 {
     Rewriter&                 mRewriter;
     std::vector<IncludeData>& mIncludes;
+    ScratchArena              mScratchArena{};  ///! Synthesized nodes of this TU which only feed the code generator.
 
 public:
     explicit CppInsightASTConsumer(Rewriter& rewriter, std::vector<IncludeData>& includes)
@@ -172,6 +214,10 @@ public:
     , mRewriter{rewriter}
     , mIncludes{includes}
     {
+        if(GetInsightsOptions().UseShowCoroutineFrame) {
+            gInsightsOptions.ShowCoroutineTransformation = true;
+        }
+
         if(GetInsightsOptions().UseShow2C) {
             if(GetInsightsOptions().ShowCoroutineTransformation) {
                 gInsightsOptions.UseShow2C = false;
@@ -183,12 +229,21 @@ public:
         if(GetInsightsOptions().ShowLifetime) {
             gInsightsOptions.UseShowInitializerList = true;
         }
+
+        if(0 == GetInsightsOptions().CachelineSize) {
+            gInsightsOptions.UseShowCachelines = false;
+        }
+
+        if(GetInsightsOptions().UseShowCachelines) {
+            gInsightsOptions.UseShowPadding = true;
+        }
     }
 
     void HandleTranslationUnit(ASTContext& context) override
     {
-        gAST     = &context;
-        auto& sm = context.getSourceManager();
+        gAST          = &context;
+        gScratchArena = &mScratchArena;
+        auto& sm      = context.getSourceManager();
 
         auto isExpansionInSystemHeader = [&sm](const Decl* d) {
             auto expansionLoc = sm.getExpansionLoc(d->getLocation());
@@ -245,6 +300,34 @@ public:
             codeGenerator->InsertArg(d);
         }
 
+        if(GetInsightsOptions().UseSuggestLayout) {
+            outputFormatHelper.Append(EmitLayoutSuggestionSummary());
+        }
+
+        if(GetInsightsOptions().UseShowCopies) {
+            outputFormatHelper.Append(EmitCopySummary());
+        }
+
+        if(GetInsightsOptions().UseShowStaticInit) {
+            outputFormatHelper.Append(EmitStaticInitReport());
+        }
+
+        if(GetInsightsOptions().UseShowStaticGuards) {
+            outputFormatHelper.Append(EmitStaticGuardReport());
+        }
+
+        if(GetInsightsOptions().UseShowInstantiationStats) {
+            outputFormatHelper.Append(EmitInstantiationStats());
+        }
+
+        if(GetInsightsOptions().UseShowExceptionCosts) {
+            outputFormatHelper.Append(EmitExceptionCostReport());
+        }
+
+        if(GetInsightsOptions().UseShowAllocations) {
+            outputFormatHelper.Append(EmitAllocationReport());
+        }
+
         std::string insightsIncludes{};
 
         if(GetInsightsOptions().ShowCoroutineTransformation) {
@@ -291,6 +374,14 @@ public:
 
             mRewriter.InsertText(cxaLoc, cxaStart);
         }
+
+        if(GetInsightsOptions().PrintStats) {
+            PrintStats(context, mScratchArena);
+        }
+
+        // The output pass is done. Drop everything which can still reach the synthesized nodes, then release them.
+        ClearTranslationUnitRegistries();
+        mScratchArena.Reset();
     }
 };
 //-----------------------------------------------------------------------------
@@ -389,6 +480,7 @@ extern struct __mptr* __vtbl_array[];
     if(auto err = opExpected.takeError()) {
         if(gAutoComplete) {
 #define INSIGHTS_OPT(option, name, deflt, description, category) llvm::outs() << "--" << option << " ";
+#define INSIGHTS_OPT_VALUE(option, name, type, deflt, description, category) llvm::outs() << "--" << option << "= ";
 
 #include "InsightsOptions.def"
 
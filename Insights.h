@@ -19,6 +19,7 @@ class CompilerInstance;
 struct InsightsOptions
 {
 #define INSIGHTS_OPT(opt, name, deflt, description, category) bool name;
+#define INSIGHTS_OPT_VALUE(opt, name, type, deflt, description, category) type name;
 #include "InsightsOptions.def"
 };
 //-----------------------------------------------------------------------------
@@ -1688,4 +1688,64 @@ void P0315Visitor_HandleLambdaExpr(CodeGenerator& cg, const LambdaExpr* expr)
 }
 //-----------------------------------------------------------------------------
 
+namespace {
+///! Only answers whether there is a lambda, without generating it like \ref P0315Visitor does.
+struct LambdaFinder : public RecursiveASTVisitor<LambdaFinder>
+{
+    bool VisitLambdaExpr(const LambdaExpr*) { return false; }
+};
+}  // namespace
+
+// The memo is keyed by the type node and not the canonical type, as the lambda lives in the sugar, e.g. a
+// DecltypeType.
+/*constinit*/ static llvm::DenseMap<const Type*, bool> gMayContainLambda{};
+/*constinit*/ static P0315Stats                       gP0315Stats{};
+//-----------------------------------------------------------------------------
+
+///! The type nodes are only valid as long as their ASTContext, the statistics are per translation unit.
+static void ResetP0315MemoOnNewAST()
+{
+    static const ASTContext* memoAST{};
+
+    if(const auto* ast = &GetGlobalAST(); ast != memoAST) {
+        gMayContainLambda.clear();
+        gP0315Stats = {};
+        memoAST     = ast;
+    }
+}
+//-----------------------------------------------------------------------------
+
+P0315Stats& GetP0315Stats()
+{
+    ResetP0315MemoOnNewAST();
+
+    return gP0315Stats;
+}
+//-----------------------------------------------------------------------------
+
+bool MayContainLambda(QualType type)
+{
+    ResetP0315MemoOnNewAST();
+
+    ++gP0315Stats.lookups;
+
+    const auto* typePtr = type.getTypePtrOrNull();
+
+    if(nullptr == typePtr) {
+        return false;
+    }
+
+    if(const auto it = gMayContainLambda.find(typePtr); it != gMayContainLambda.end()) {
+        return it->second;
+    }
+
+    ++gP0315Stats.walks;
+
+    const bool ret = not LambdaFinder{}.TraverseType(type);
+    gMayContainLambda[typePtr] = ret;
+
+    return ret;
+}
+//-----------------------------------------------------------------------------
+
 }  // namespace clang::insights
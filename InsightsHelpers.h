@@ -359,6 +359,21 @@ void P0315Visitor_HandleLambdaExpr(class OutputFormatHelper&, const LambdaExpr*)
 void P0315Visitor_HandleLambdaExpr(class CodeGenerator&, const LambdaExpr*);
 //-----------------------------------------------------------------------------
 
+///! Whether \p type can contain a \c LambdaExpr (P0315). The answer is memoized per type node for the whole TU.
+bool MayContainLambda(QualType type);
+//-----------------------------------------------------------------------------
+
+///! How often the P0315 type checks ran and how often they were answered from the memo.
+struct P0315Stats
+{
+    size_t lookups{};     ///! Calls to \ref MayContainLambda.
+    size_t walks{};       ///! Types which were walked to fill the memo.
+    size_t traversals{};  ///! Traversals of a \ref P0315Visitor which actually ran.
+};
+
+P0315Stats& GetP0315Stats();
+//-----------------------------------------------------------------------------
+
 ///! Find a LambdaExpr inside a Decltype
 template<typename T>
     requires(std::derived_from<T, CodeGenerator> or std::same_as<T, OutputFormatHelper>)
@@ -382,6 +397,19 @@ public:
         return false;
     }
 
+    ///! Traverse \p type only if it can contain a lambda at all. Like \c TraverseType it returns false, if a lambda
+    ///! was found.
+    bool TraverseTypeIfLambda(QualType type)
+    {
+        if(not MayContainLambda(type)) {
+            return true;
+        }
+
+        ++GetP0315Stats().traversals;
+
+        return this->TraverseType(type);
+    }
+
     const LambdaExpr* Get() const { return mLambdaExpr; }
 };
 //-----------------------------------------------------------------------------
@@ -0,0 +1,77 @@
+/******************************************************************************
+ *
+ * C++ Insights, copyright (C) by Andreas Fertig
+ * Distributed under an MIT license. See LICENSE for details
+ *
+ ****************************************************************************/
+
+#ifndef INSIGHTS_SCRATCH_ARENA_H
+#define INSIGHTS_SCRATCH_ARENA_H
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "llvm/Support/Allocator.h"
+//-----------------------------------------------------------------------------
+
+namespace clang::insights {
+
+/// \brief Memory for AST nodes which are synthesized only to feed the code generator.
+///
+/// Nodes created in the \c ASTContext live as long as the context, even if they are needed only while generating the
+/// output. The arena is owned by the AST consumer of the translation unit and released after each output pass. Nodes
+/// taken from it must therefore not be kept across passes. Destructors of the nodes are not called, which is fine for
+/// \c Stmt's, as the \c ASTContext does not call them either.
+class ScratchArena
+{
+public:
+    ScratchArena() = default;
+
+    ScratchArena(const ScratchArena&)            = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    template<typename T, typename... Args>
+    T* New(Args&&... args)
+    {
+        ++mNodes;
+
+        return new(mAllocator.Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /// \brief Copy a string into the arena. The result lives until the next \ref Reset.
+    std::string_view Copy(std::string_view str)
+    {
+        if(str.empty()) {
+            return {};
+        }
+
+        auto* mem = static_cast<char*>(mAllocator.Allocate(str.size(), alignof(char)));
+        std::copy(str.begin(), str.end(), mem);
+
+        return {mem, str.size()};
+    }
+
+    void Reset()
+    {
+        mAllocator.Reset();
+        mNodes = 0;
+    }
+
+    size_t BytesAllocated() const { return mAllocator.getBytesAllocated(); }
+    size_t TotalMemory() const { return mAllocator.getTotalMemory(); }
+    size_t Nodes() const { return mNodes; }
+
+private:
+    llvm::BumpPtrAllocator mAllocator{};
+    size_t                 mNodes{};
+};
+//-----------------------------------------------------------------------------
+
+/// \brief Get access to the scratch arena of the current translation unit.
+ScratchArena& GetScratchArena();
+//-----------------------------------------------------------------------------
+
+}  // namespace clang::insights
+
+#endif /* INSIGHTS_SCRATCH_ARENA_H */
@@ -24,21 +24,42 @@ void LifetimeTracker::StartScope(bool funcStart)
 {
     RETURN_IF(not GetInsightsOptions().ShowLifetime)
 
-    ++scopeCounter;
+    scopes.emplace_back().funcStart = funcStart ? LifetimeScope::FuncStart::Yes : LifetimeScope::FuncStart::No;
+}
+//-----------------------------------------------------------------------------
+
+LifetimeEntry* LifetimeTracker::NewEntry(const VarDecl* decl, size_t scope)
+{
+    LifetimeEntry* entry{};
+
+    if(freeEntries.empty()) {
+        entry = new(allocator.Allocate()) LifetimeEntry{};
+
+    } else {
+        entry = &freeEntries.front();
+        freeEntries.pop_front();
+    }
 
-    objects.push_back(
-        {.funcStart = funcStart ? LifetimeEntry::FuncStart::Yes : LifetimeEntry::FuncStart::No, .scope = scopeCounter});
+    entry->item   = decl;
+    entry->scope  = scope;
+    entries[decl] = entry;
+
+    return entry;
 }
 //-----------------------------------------------------------------------------
 
 void LifetimeTracker::AddExtended(const VarDecl* decl, const ValueDecl* extending)
 {
-    // Search for the extending VarlDecl which is already in `objects`. Insert this decl _after_
-    if(auto it = std::ranges::find_if(objects, [&](const auto& e) { return e.item == extending; });
-       it != objects.end()) {
-        const auto scope = (*it).scope;
-        objects.insert(std::next(it), {decl, LifetimeEntry::FuncStart::No, scope});
-    }
+    // Search for the extending VarlDecl which is already tracked. Insert this decl _after_ it in the same scope.
+    const auto* extendingVarDecl = dyn_cast_or_null<VarDecl>(extending);
+    RETURN_IF(not extendingVarDecl or entries.contains(decl));
+
+    auto it = entries.find(extendingVarDecl);
+    RETURN_IF(entries.end() == it);
+
+    auto* extendingEntry = it->second;
+    auto& scope          = scopes[extendingEntry->scope];
+    scope.objects.insert(std::next(extendingEntry->getIterator()), *NewEntry(decl, extendingEntry->scope));
 }
 //-----------------------------------------------------------------------------
 
@@ -51,10 +72,14 @@ void LifetimeTracker::Add(const VarDecl* decl)
     RETURN_IF(type->isPointerType() or type->isRValueReferenceType());
 
     // For life-time extended objects
-    // XXX contains in C++23
-    RETURN_IF(std::ranges::find_if(objects, [&](const auto& e) { return e.item == decl; }) != objects.end());
+    RETURN_IF(entries.contains(decl));
+
+    // Objects added outside of any scope, for example globals, live in an implicit outermost scope.
+    if(scopes.empty()) {
+        scopes.emplace_back();
+    }
 
-    objects.push_back({decl, LifetimeEntry::FuncStart::No, scopeCounter});
+    scopes.back().objects.push_back(*NewEntry(decl, scopes.size() - 1));
 }
 //-----------------------------------------------------------------------------
 
@@ -111,26 +136,24 @@ void LifetimeTracker::InsertDtorCall(const VarDecl* vd, OutputFormatHelper& ofm)
 
 bool LifetimeTracker::Return(OutputFormatHelper& ofm)
 {
-    RETURN_FALSE_IF(not GetInsightsOptions().ShowLifetime or objects.empty())
+    RETURN_FALSE_IF(not GetInsightsOptions().ShowLifetime or scopes.empty())
 
     bool ret{};
 
-    for(OnceTrue needsSemi{}; auto& e : llvm::reverse(objects)) {
-        if(LifetimeEntry::FuncStart::Yes == e.funcStart) {
-            break;
-        }
+    for(OnceTrue needsSemi{}; auto& scope : llvm::reverse(scopes)) {
+        for(auto& e : llvm::reverse(scope.objects)) {
+            if(needsSemi) {
+                CodeGeneratorVariant cg{ofm};
+                cg->InsertArg(mkNullStmt());
+            }
 
-        if(nullptr == e.item) {
-            continue;
+            InsertDtorCall(e.item, ofm);
+            ret = true;
         }
 
-        if(needsSemi) {
-            CodeGeneratorVariant cg{ofm};
-            cg->InsertArg(mkNullStmt());
+        if(LifetimeScope::FuncStart::Yes == scope.funcStart) {
+            break;
         }
-
-        InsertDtorCall(e.item, ofm);
-        ret = true;
     }
 
     return ret;
@@ -139,31 +162,27 @@ bool LifetimeTracker::Return(OutputFormatHelper& ofm)
 
 void LifetimeTracker::removeTop()
 {
-    objects.pop_back();
+    auto& scope = scopes.back();
 
-    auto it = std::ranges::remove_if(objects, [&](const LifetimeEntry& e) { return (e.scope == scopeCounter); });
-    objects.erase(it.begin(), it.end());
+    for(const auto& e : scope.objects) {
+        entries.erase(e.item);
+    }
+
+    // Keep the entries around for the objects of the next scopes
+    freeEntries.splice(freeEntries.end(), scope.objects);
 
-    --scopeCounter;
+    scopes.pop_back();
 }
 //-----------------------------------------------------------------------------
 
 bool LifetimeTracker::EndScope(OutputFormatHelper& ofm, bool coveredByReturn)
 {
-    RETURN_FALSE_IF(not GetInsightsOptions().ShowLifetime or objects.empty())
+    RETURN_FALSE_IF(not GetInsightsOptions().ShowLifetime or scopes.empty())
 
     bool ret{};
 
     if(not coveredByReturn) {
-        for(auto& e : llvm::reverse(objects)) {
-            if(e.scope != scopeCounter) {
-                break;
-            }
-
-            if(nullptr == e.item) {
-                break;
-            }
-
+        for(auto& e : llvm::reverse(scopes.back().objects)) {
             InsertDtorCall(e.item, ofm);
             ret = true;
         }
@@ -14,7 +14,7 @@
 using namespace std;
 
 /// \brief Create a markdown file which contains the information about the option.
-static bool CreateFile(const std::string& optionName, bool optionDefault, const char* description)
+static bool CreateFile(const std::string& optionName, const std::string& optionDefault, const char* description)
 {
     const std::string mdFileName{"opt-" + optionName + ".md"};
     ofstream          mdFile{mdFileName};
@@ -29,7 +29,7 @@ static bool CreateFile(const std::string& optionName, bool optionDefault, const
 
     mdFile << "# " << optionName << " {#" << linkName << "}\n";
     mdFile << description << "\n\n";
-    mdFile << "__Default:__ " << (optionDefault ? "On" : "Off") << "\n\n";
+    mdFile << "__Default:__ " << optionDefault << "\n\n";
     mdFile << "__Examples:__\n\n";
     mdFile << "```.cpp\n";
     mdFile << optionName << "-source\n";
@@ -45,11 +45,11 @@ static bool CreateFile(const std::string& optionName, bool optionDefault, const
 
 int main()
 {
-#define INSIGHTS_OPT(opt, name, deflt, description, category) CreateFile(opt, deflt, description);
+#define INSIGHTS_OPT(opt, name, deflt, description, category) CreateFile(opt, deflt ? "On" : "Off", description);
+#define INSIGHTS_OPT_VALUE(opt, name, type, deflt, description, category)                                              \
+    CreateFile(opt, std::to_string(deflt), description);
 #include "../InsightsOptions.def"
 
-#undef INSIGHTS_OPT
-
     ofstream mdFile{"CommandLineOptions.md"};
 
     if(not mdFile.is_open()) {
@@ -61,6 +61,7 @@ int main()
     std::vector<std::string> options{};
 
 #define INSIGHTS_OPT(opt, name, deflt, description, category) options.emplace_back(opt);
+#define INSIGHTS_OPT_VALUE(opt, name, type, deflt, description, category) options.emplace_back(opt);
 #include "../InsightsOptions.def"
 
     sort(options.begin(), options.end());
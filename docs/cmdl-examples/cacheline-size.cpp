@@ -0,0 +1,9 @@
+#include <atomic>
+
+struct Counters
+{
+    std::atomic<int> produced;
+    std::atomic<int> consumed;
+    char             name[60];
+    long             total;
+};
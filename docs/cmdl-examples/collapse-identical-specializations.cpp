@@ -0,0 +1,8 @@
+template<typename T>
+struct Box
+{
+    T value;
+};
+
+Box<int*>  a{};
+Box<char*> b{};
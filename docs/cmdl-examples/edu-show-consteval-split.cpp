@@ -0,0 +1,28 @@
+int Next();
+
+constexpr int Square(int x)
+{
+    return x * x;
+}
+
+constexpr int kSize   = Square(4);
+int           counter = Next();
+
+int Compute(int a)
+{
+    const int        n     = 5;
+    int              y     = n * 2;
+    int              z     = a + y;
+    static const int limit = Square(3);
+    static const int start = Next();
+
+    if(n > 3) {
+        return z;
+    }
+
+    if(a > limit) {
+        return start;
+    }
+
+    return Square(a);
+}
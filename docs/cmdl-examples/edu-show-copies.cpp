@@ -0,0 +1,22 @@
+struct Heavy
+{
+    Heavy() {}
+    Heavy(const Heavy&) {}
+
+    char data[64];
+};
+
+void Consume(Heavy h) {}
+
+void Copies()
+{
+    Heavy a{};
+    Consume(a);
+    Consume(a);
+}
+
+void Loop(Heavy (&arr)[2])
+{
+    for(Heavy h : arr) {
+    }
+}
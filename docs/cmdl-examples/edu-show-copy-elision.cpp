@@ -0,0 +1,42 @@
+#include <utility>
+
+struct C
+{
+    C() = default;
+    C(const C&) {}
+    C(C&&) {}
+};
+
+C Prvalue()
+{
+    return C{};
+}
+
+C Nrvo()
+{
+    C c{};
+    return c;
+}
+
+C TwoLocals(bool b)
+{
+    C x{};
+    C y{};
+
+    if(b) {
+        return x;
+    }
+
+    return y;
+}
+
+C Moved()
+{
+    C c{};
+    return std::move(c);
+}
+
+C Copy(const C& c)
+{
+    return c;
+}
@@ -0,0 +1,15 @@
+struct Buffer
+{
+    Buffer() {}
+    Buffer(Buffer&&) {}
+    ~Buffer() {}
+};
+
+int Load(int i);
+
+int Process(int i)
+{
+    Buffer buffer;
+
+    return Load(i);
+}
@@ -0,0 +1,39 @@
+struct Counter
+{
+  Counter(int start) : value{start} {}
+
+  int value;
+};
+
+struct Config
+{
+  constexpr Config(int l) : level{l} {}
+  ~Config() {}
+
+  int level;
+};
+
+Counter& GetCounter()
+{
+  static Counter counter(0);
+
+  return counter;
+}
+
+Config& GetConfig(int l)
+{
+  static Config config(l);
+
+  return config;
+}
+
+int Sum(int n)
+{
+  int sum = 0;
+
+  for(int i = 0; i < n; ++i) {
+    sum += GetCounter().value;
+  }
+
+  return sum + GetConfig(n).level;
+}
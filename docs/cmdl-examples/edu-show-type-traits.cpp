@@ -0,0 +1,23 @@
+struct Point
+{
+    int x;
+    int y;
+};
+
+struct Handle
+{
+    Handle(Handle&& other) : fd{other.fd} {}
+
+    int fd;
+};
+
+class Shape
+{
+public:
+    virtual void Draw() {}
+
+    int count = 0;
+
+private:
+    Handle handle;
+};
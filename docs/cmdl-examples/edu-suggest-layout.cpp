@@ -0,0 +1,17 @@
+struct Data
+{
+    char   a;
+    double d;
+    char   b;
+    int    i;
+};
+
+struct Flags
+{
+    char     c;
+    unsigned x : 3;
+    unsigned y : 5;
+    long     l;
+    short    s;
+};
+
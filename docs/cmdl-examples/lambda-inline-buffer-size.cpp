@@ -0,0 +1,10 @@
+int main()
+{
+    char   c = 1;
+    double d = 2;
+    int    i = 3;
+
+    auto large = [c, d, i] { return c + d + i; };
+
+    return static_cast<int>(large());
+}
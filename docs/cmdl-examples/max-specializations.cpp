@@ -0,0 +1,9 @@
+template<typename T>
+T Identity(T t)
+{
+    return t;
+}
+
+int  i = Identity(1);
+long l = Identity(2L);
+char c = Identity('c');
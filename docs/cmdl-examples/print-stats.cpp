@@ -0,0 +1,5 @@
+// The statistics go to stderr, the transformed code is not affected.
+int main()
+{
+    int x = 2;
+}
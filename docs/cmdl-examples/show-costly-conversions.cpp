@@ -0,0 +1,35 @@
+struct Base { int b; };
+struct Derived : virtual Base { int d; };
+
+struct Meters
+{
+    operator double() const { return value; }
+    double value;
+};
+
+struct Text
+{
+    using allocator_type = int;
+
+    Text(const char* s) : data{s} {}
+    const char* data;
+};
+
+void Log(const Text& t) {}
+
+double Scale(int i, float f, long l, const Derived& d, Meters m)
+{
+    double a = i;
+    int    b = f;
+    float  c = a;
+    short  s = l;
+    long   w = i;
+    double k = 2;
+
+    const Base& base = d;
+    double      x    = m;
+
+    Log("hello");
+
+    return a + x;
+}
@@ -0,0 +1,11 @@
+// cmdlineinsights:-edu-show-cachelines
+
+#include <atomic>
+
+struct Counters
+{
+    std::atomic<int> produced;
+    std::atomic<int> consumed;
+    char             name[60];
+    long             total;
+};
@@ -0,0 +1,19 @@
+// cmdlineinsights:-collapse-identical-specializations
+
+template<typename T>
+struct Box
+{
+    T value;
+};
+
+Box<int*>  a{};
+Box<char*> b{};
+
+template<typename T>
+T Identity(T t)
+{
+    return t;
+}
+
+int  i = Identity(1);
+long l = Identity(2L);
@@ -0,0 +1,28 @@
+// cmdlineinsights:-edu-show-allocations
+
+#include <memory>
+#include <string>
+#include <vector>
+
+std::shared_ptr<int> Create()
+{
+    return std::make_shared<int>(42);
+}
+
+int Fill(int n, const char* name)
+{
+    int*             raw = new int[n];
+    std::vector<int> values{};
+
+    for(int i = 0; i < n; ++i) {
+        std::string copy{name};
+        values.push_back(raw[i] + static_cast<int>(copy.size()));
+    }
+
+    std::string title{"title"};
+    std::string banner{"a literal which exceeds the small buffer"};
+
+    delete[] raw;
+
+    return static_cast<int>(values.size() + title.size() + banner.size());
+}
@@ -0,0 +1,52 @@
+// cmdlineinsights:-edu-show-copies
+
+struct Heavy
+{
+    Heavy() {}
+    Heavy(const Heavy&) {}
+    Heavy& operator=(const Heavy&) { return *this; }
+
+    char data[64];
+};
+
+void Consume(Heavy h) {}
+
+void Copies()
+{
+    Heavy a{};
+    Consume(a);
+    Consume(a);
+}
+
+void Loop(Heavy (&arr)[2])
+{
+    for(Heavy h : arr) {
+    }
+}
+
+Heavy Pick(bool b)
+{
+    Heavy x{};
+    Heavy y{};
+
+    if(b) {
+        return x;
+    }
+
+    return y;
+}
+
+void Assign()
+{
+    Heavy a{};
+    Heavy b{};
+    b = static_cast<Heavy&&>(a);
+}
+
+char Capture()
+{
+    Heavy h{};
+    auto  l = [h] { return h.data[0]; };
+
+    return l();
+}
@@ -0,0 +1,77 @@
+// cmdlineinsights:-edu-show-copy-elision
+
+#include <utility>
+
+struct C
+{
+    C() = default;
+    C(const C&) {}
+    C(C&&) {}
+};
+
+C Prvalue()
+{
+    return C{};
+}
+
+C Nrvo()
+{
+    C c{};
+    return c;
+}
+
+C TwoLocals(bool b)
+{
+    C x{};
+    C y{};
+
+    if(b) {
+        return x;
+    }
+
+    return y;
+}
+
+C Moved()
+{
+    C c{};
+    return std::move(c);
+}
+
+C Copy(const C& c)
+{
+    return c;
+}
+
+struct D
+{
+    D() = default;
+    D(const D&) {}
+};
+
+D CopyOnly(bool b)
+{
+    D x{};
+    D y{};
+
+    if(b) {
+        return x;
+    }
+
+    return y;
+}
+
+C ByValue(C c)
+{
+    return c;
+}
+
+struct Derived : C
+{
+};
+
+C Sliced()
+{
+    Derived d;
+    return d;
+}
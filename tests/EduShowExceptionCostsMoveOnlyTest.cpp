@@ -0,0 +1,13 @@
+// cmdlineinsights:-edu-show-exception-costs
+
+struct Handle
+{
+    Handle() {}
+    Handle(Handle&&) {}
+};
+
+struct Owner
+{
+    Handle handle;
+    int    id;
+};
@@ -0,0 +1,56 @@
+// cmdlineinsights:-edu-show-exception-costs
+
+struct Buffer
+{
+    Buffer() {}
+    Buffer(const Buffer&) {}
+    Buffer(Buffer&&) {}
+    ~Buffer() {}
+};
+
+struct Holder
+{
+    Buffer buffer;
+    int    id;
+};
+
+int Load(int i);
+
+int Use(const Buffer& buffer);
+
+int Twice(int i) noexcept
+{
+    return i * 2;
+}
+
+int Sum(int a, int b)
+{
+    return a + b;
+}
+
+int Process(int i)
+{
+    Buffer buffer;
+    Load(i);
+
+    return Twice(i) + Load(i);
+}
+
+int Finish(int i) noexcept
+{
+    return Load(i);
+}
+
+int Safe(int i)
+{
+    try {
+        return Load(i);
+    } catch(...) {
+        return 0;
+    }
+}
+
+int Temporary(int i)
+{
+    return Use(Buffer()) + Load(i);
+}
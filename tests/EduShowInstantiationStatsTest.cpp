@@ -0,0 +1,20 @@
+// cmdlineinsights:-edu-show-instantiation-stats
+
+template<typename T>
+struct Box
+{
+    T value;
+};
+
+Box<int>  a{};
+Box<char> b{};
+Box<long> c{};
+
+template<typename T>
+T Identity(T t)
+{
+    return t;
+}
+
+int  i = Identity(1);
+long l = Identity(2L);
@@ -0,0 +1,13 @@
+// cmdlineinsights:-edu-show-lambda-layout
+
+int main()
+{
+    char   c = 1;
+    double d = 2;
+    int    i = 3;
+
+    auto small = [c, i] { return c + i; };
+    auto large = [c, d, i] { return c + d + i; };
+
+    return small() + static_cast<int>(large());
+}
@@ -0,0 +1,32 @@
+// cmdlineinsights:-edu-show-static-init
+
+struct Logger
+{
+  Logger(int level) noexcept : level{level} {}
+  ~Logger() {}
+
+  int level;
+};
+
+struct Point
+{
+  constexpr Point(int v) : x{v} {}
+
+  int x;
+};
+
+int Compute()
+{
+  return 3;
+}
+
+Logger gLogger(1);
+Point gPoint(Compute());
+Point gOrigin(0);
+
+Logger& Get()
+{
+  static Logger instance(2);
+
+  return instance;
+}
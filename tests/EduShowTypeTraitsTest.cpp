@@ -0,0 +1,25 @@
+// cmdlineinsights:-edu-show-type-traits
+
+struct Point
+{
+    int x;
+    int y;
+};
+
+struct Handle
+{
+    Handle(Handle&& other) : fd{other.fd} {}
+
+    int fd;
+};
+
+class Shape
+{
+public:
+    virtual void Draw() {}
+
+    int count = 0;
+
+private:
+    Handle handle;
+};
@@ -0,0 +1,27 @@
+// cmdlineinsights:-edu-show-padding
+
+struct Empty {};
+
+struct Less : Empty {};
+
+struct Hash : Empty {};
+
+struct Node {
+    Less less;
+    int  value;
+};
+
+struct CompactNode {
+    [[no_unique_address]] Less less;
+    int                        value;
+};
+
+struct Holder : Less {
+    int value;
+};
+
+struct Blocked : Less {
+    Holder holder;
+};
+
+struct Policies : Less, Hash {};
@@ -0,0 +1,31 @@
+// cmdlineinsights:-show-costly-conversions
+
+#include <string>
+
+struct Base { int b; };
+struct Derived : virtual Base { int d; };
+
+struct Meters
+{
+    operator double() const { return value; }
+    double value;
+};
+
+void Log(const std::string& t) {}
+
+double Scale(int i, float f, long l, const Derived& d, Meters m)
+{
+    double a = i;
+    int    b = f;
+    float  c = a;
+    short  s = l;
+    long   w = i;
+    double k = 2;
+
+    const Base& base = d;
+    double      x    = m;
+
+    Log("hello");
+
+    return a + x;
+}
@@ -0,0 +1,6 @@
+using Add = decltype([](int a, int b) { return a + b; });
+
+int Sum(int a, int b)
+{
+    return Add{}(a, b);
+}
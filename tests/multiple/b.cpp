@@ -0,0 +1,6 @@
+using Twice = decltype([](int a) { return a * 2; });
+
+int Double(int a)
+{
+    return Twice{}(a);
+}
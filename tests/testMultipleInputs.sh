@@ -0,0 +1,26 @@
+#! /bin/bash
+
+# fail immediately
+set -e
+
+# Each input is a translation unit of its own. Neither the output nor the statistics of an input may depend on the
+# inputs processed before it.
+cd multiple
+
+single="$($1 a.cpp -- -std=c++20; $1 b.cpp -- -std=c++20)"
+multiple="$($1 a.cpp b.cpp -- -std=c++20)"
+
+if [ "$single" != "$multiple" ]; then
+    echo "[FAILED] output of multiple inputs differs from the one of single inputs"
+    exit 1
+fi
+
+single="$({ $1 -print-stats a.cpp -- -std=c++20; $1 -print-stats b.cpp -- -std=c++20; } 2>&1 >/dev/null | grep "P0315")"
+multiple="$($1 -print-stats a.cpp b.cpp -- -std=c++20 2>&1 >/dev/null | grep "P0315")"
+
+if [ "$single" != "$multiple" ]; then
+    echo "[FAILED] statistics of multiple inputs differ from the ones of single inputs"
+    exit 1
+fi
+
+exit 0